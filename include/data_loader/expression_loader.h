@@ -1,12 +1,30 @@
 #pragma once
 
 #include "types/expression_data.h"
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <span>
+#include <vector>
 
 using namespace std;
 
 namespace gsea {
 
+// FNV-1a hashes of the raw text of sample columns, so a column can be
+// recognised as unchanged without parsing it.
+struct ColumnFingerprints {
+    vector<uint64_t> loaded;               // one per loaded sample column
+    vector<optional<uint64_t>> skipped;    // one per skip_samples name, nullopt if absent
+};
+
 ExpressionData load_expression_data(const string& filepath);
 
+// Loads only the sample columns not named in skip_samples, e.g. those
+// appended since a previous run. Skipped columns are split and hashed but
+// not parsed. Fingerprints of both kinds of column go to fingerprints.
+ExpressionData load_expression_data(const string& filepath,
+                                    span<const string> skip_samples,
+                                    ColumnFingerprints& fingerprints);
+
 } // namespace gsea
\ No newline at end of file
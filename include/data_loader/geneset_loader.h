@@ -1,6 +1,8 @@
 #pragma once
 
 #include "types/gene_set.h"
+#include <limits>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -8,7 +10,39 @@ using namespace std;
 
 namespace gsea {
 
+// Selects which GMT entries are materialised. Sizes count the genes that
+// match the expression data; name filters are applied before any parsing.
+struct GeneSetFilter {
+    size_t min_size = 1;
+    size_t max_size = numeric_limits<size_t>::max();
+    string name_prefix;    // keep names starting with this, if non-empty
+    string name_pattern;   // keep names fully matching this ECMAScript regex, if non-empty
+};
+
+// A GMT entry tokenised into gene symbols, not yet matched to expression rows.
+struct GeneSetRecord {
+    string name;
+    size_t line_num;
+    vector<string> genes;
+};
+
+// Tokenises the entries that pass the name filters; needs no expression data,
+// so it can run while the matrix is still loading. With a name filter,
+// plain-text GMT files are read through a cached byte-offset index (see
+// load_gmt_index), seeking only to selected entries; otherwise, and for
+// compressed files, the file is streamed. Size bounds are left to
+// resolve_gene_sets.
+vector<GeneSetRecord> read_gene_set_records(const string& filepath,
+                                            const GeneSetFilter& filter = {});
+
+// Matches records against the expression gene names and applies the size
+// filter.
+vector<GeneSet> resolve_gene_sets(span<const GeneSetRecord> records,
+                                  span<const string> gene_names,
+                                  const GeneSetFilter& filter = {});
+
 vector<GeneSet> load_gene_sets(const string& filepath,
-                                     const vector<string>& gene_names);
+                                     span<const string> gene_names,
+                                     const GeneSetFilter& filter = {});
 
 } // namespace gsea
\ No newline at end of file
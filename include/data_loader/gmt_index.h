@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+struct GmtIndexEntry {
+    string name;
+    uint64_t offset;      // byte offset of the line in the GMT file
+    uint32_t length;      // line length in bytes, excluding the newline
+    uint32_t line_num;
+};
+
+// Byte-offset index of a plain-text GMT file. It is cached beside the file
+// as <filepath>.idx and rebuilt when the GMT's size or modification time no
+// longer matches; if the cache cannot be written the index is still returned.
+[[nodiscard]] vector<GmtIndexEntry> load_gmt_index(const string& filepath);
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+using namespace std;
+
+namespace gsea {
+
+// Line-oriented reader over plain, gzip (.gz) or zstd (.zst) files. The
+// compression format is detected from the file's magic bytes. Decoding runs on
+// a background thread that fills a bounded ring of buffers, so decompression
+// overlaps with parsing on the calling thread.
+class InputStream {
+public:
+    explicit InputStream(const string& filepath);
+    ~InputStream();
+
+    InputStream(const InputStream&) = delete;
+    InputStream& operator=(const InputStream&) = delete;
+
+    [[nodiscard]] bool is_open() const noexcept;
+    explicit operator bool() const noexcept { return is_open(); }
+
+    // Reads the next line without its trailing '\n'. Returns false at end of
+    // input; rethrows any decoding error raised on the background thread.
+    bool read_line(string& line);
+
+private:
+    struct Impl;
+    unique_ptr<Impl> impl_;
+};
+
+// True if the file starts with a gzip or zstd magic number.
+[[nodiscard]] bool is_compressed_file(const string& filepath);
+
+inline bool getline(InputStream& stream, string& line) {
+    return stream.read_line(line);
+}
+
+} // namespace gsea
\ No newline at end of file
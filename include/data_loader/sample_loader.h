@@ -2,6 +2,7 @@
 
 #include "types/sample_data.h"
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -9,4 +10,13 @@ namespace gsea {
 
 SampleData load_sample_data(const string& filepath);
 
+// Continuous covariate per sample, such as dose, age or a biomarker level.
+struct ContinuousPhenotype {
+    vector<string> sample_names;
+    vector<double> values;
+};
+
+// Same two-column layout as the sample file, with any finite number as value.
+ContinuousPhenotype load_continuous_phenotype(const string& filepath);
+
 } // namespace gsea
\ No newline at end of file
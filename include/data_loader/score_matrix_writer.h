@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types/score_matrix.h"
+#include <span>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+namespace gsea {
+
+// Tab-separated, with a header row of row_header and the column names, and
+// the row name first on each line.
+void write_score_matrix_tsv(const string& filepath,
+                            const ScoreMatrix& scores,
+                            span<const string> row_names,
+                            span<const string> column_names,
+                            string_view row_header);
+
+// Little-endian binary layout, with the values first so they can be mapped
+// directly:
+//   char[8]   magic "GSEAMAT1"
+//   uint64    rows, cols
+//   float64   rows * cols values, row-major
+//   rows + cols names, each as uint32 length followed by the bytes
+void write_score_matrix_binary(const string& filepath,
+                               const ScoreMatrix& scores,
+                               span<const string> row_names,
+                               span<const string> column_names);
+
+} // namespace gsea
\ No newline at end of file
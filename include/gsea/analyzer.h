@@ -3,19 +3,64 @@
 #include "types/expression_data.h"
 #include "types/sample_data.h"
 #include "types/gene_set.h"
+#include "gsea/statistics.h"
+#include "gsea/overlap.h"
+#include "data_loader/geneset_loader.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <optional>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <span>
 
 using namespace std;
 
 namespace gsea {
 
+// Snapshot of an anytime significance run, in gene set order.
+struct SignificanceProgress {
+    size_t permutations;                     // completed so far
+    chrono::steady_clock::duration elapsed;
+    double corrected_p;                      // Bonferroni threshold
+    vector<PValueEstimate> estimates;
+    vector<ConfidenceInterval> intervals;    // around each empirical p-value
+    vector<uint8_t> significant;             // p_value < corrected_p
+    vector<uint8_t> decided;                 // interval excludes corrected_p
+    size_t num_decided;
+};
+
+// Receives each snapshot; returning false stops the run.
+using SignificanceCallback = function<bool(const SignificanceProgress&)>;
+
+// Size of the next anytime batch, at most batch_size: the probe_size probe
+// when no permutations have run, otherwise as many as fit in remaining at
+// the rate measured over spent. Returns 0 when none fit.
+[[nodiscard]] size_t plan_anytime_batch(size_t batch_size,
+                                        size_t probe_size,
+                                        size_t permutations,
+                                        chrono::duration<double> spent,
+                                        chrono::duration<double> remaining);
+
 class GSEAAnalyzer {
 public:
+    // Reads the three files concurrently; gene sets are tokenised while the
+    // expression matrix loads and resolved once its gene names are known.
     GSEAAnalyzer(const string& exp_file,
                  const string& samp_file,
-                 const string& geneset_file);
+                 const string& geneset_file,
+                 const GeneSetFilter& filter = {});
+
+    // Zero-copy construction for embedding: every buffer is borrowed and must
+    // outlive the analyzer. Expression columns are the samples, labelled by
+    // disease_status (1 = diseased, 0 = healthy); gene sets are views over
+    // pre-resolved row indices. Throws invalid_argument if gene_sets is empty.
+    GSEAAnalyzer(MatrixView values,
+                 span<const string> gene_names,
+                 span<const string> sample_names,
+                 span<const uint8_t> disease_status,
+                 vector<GeneSet> gene_sets);
 
     vector<string> get_gene_rank_order();
 
@@ -24,16 +69,84 @@ public:
 
     unordered_map<string, double> compute_all_enrichment_scores();
 
-    vector<string> get_significant_sets(double p_value, size_t sample_size);
+    // Per-set p-values from sample_size label permutations, in gene set order.
+    vector<PValueEstimate> get_p_values(size_t sample_size,
+                                        bool tail_approximation = false);
+
+    vector<string> get_significant_sets(double p_value, size_t sample_size,
+                                        bool tail_approximation = false);
+
+    // Runs permutations in batches until time_budget has elapsed, every set's
+    // decision at p_value (Bonferroni corrected) is settled by its confidence
+    // interval, max_permutations is reached or on_progress returns false.
+    // Publishes a snapshot after every batch and returns the last one. Uses
+    // the NUMA setting but not the permutation store, and reports empirical
+    // p-values only.
+    //
+    // The first batch is a probe of one permutation per hardware thread and
+    // always runs. Each later batch is shrunk to the permutations expected to
+    // fit in the remaining budget at the measured rate (see
+    // plan_anytime_batch), or skipped if none do, so the budget is overshot
+    // by at most the probe or by one batch's misestimate when permutations
+    // slow down.
+    SignificanceProgress get_significant_sets_anytime(
+        double p_value,
+        chrono::steady_clock::duration time_budget,
+        const SignificanceCallback& on_progress = {},
+        size_t batch_size = 100,
+        double confidence = 0.99,
+        size_t max_permutations = SIZE_MAX);
+
+    [[nodiscard]] span<const GeneSet> gene_sets() const noexcept { return gene_sets_; }
 
     [[nodiscard]] size_t num_gene_sets() const { return gene_sets_.size(); }
 
+    // Drops gene sets whose similarity to a larger kept set reaches threshold
+    // (see select_nonredundant_sets); returns the number removed.
+    size_t collapse_redundant_sets(double threshold,
+                                   OverlapMetric metric = OverlapMetric::Jaccard);
+
+    // Run permutations NUMA-aware (see compute_null_distribution_numa)
+    void set_numa(bool enabled) noexcept { numa_ = enabled; }
+
+    // Draw permutations from a persistent store in directory (see
+    // PermutationStore), seeded so that reruns and new gene set collections
+    // reuse the same stored rankings.
+    void set_permutation_store(string directory, uint64_t seed);
+
 private:
+    struct LoadedInputs;
+    static LoadedInputs load_inputs(const string& exp_file,
+                                    const string& samp_file,
+                                    const string& geneset_file,
+                                    const GeneSetFilter& filter);
+    explicit GSEAAnalyzer(LoadedInputs&& inputs);
+
+    // Sets with identical members are scored once: representatives_ holds the
+    // gene_sets_ index of one set per distinct membership, and unique_index_
+    // maps every gene set to its representative's position. Indices rather
+    // than views keep the analyzer safe to copy and move.
+    void index_unique_sets();
+    [[nodiscard]] vector<GeneSet> unique_sets() const;
+    [[nodiscard]] vector<double> score_unique_sets(span<const GeneSet> unique_sets);
+    void compute_unique_null(span<const GeneSet> unique_sets,
+                             size_t sample_size,
+                             span<double> null_distribution);
+
     ExpressionData expression_;
     SampleData samples_;
     vector<GeneSet> gene_sets_;
+    vector<size_t> representatives_;
+    vector<size_t> unique_index_;
     vector<size_t> gene_rank_;
     unordered_map<string, size_t> sample_to_column_;
+    bool numa_ = false;
+
+    struct PermutationStoreConfig {
+        string directory;
+        uint64_t seed;
+    };
+    optional<PermutationStoreConfig> permutation_store_;
 };
 
 } // namespace gsea
\ No newline at end of file
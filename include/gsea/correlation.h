@@ -0,0 +1,50 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include "types/gene_set.h"
+#include "data_loader/sample_loader.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+enum class CorrelationMethod {
+    Pearson,
+    Spearman   // Pearson on within-row ranks, ties averaged
+};
+
+// Expression of the phenotyped samples with every gene row centred and
+// scaled to unit norm, and the phenotype standardised the same way, so the
+// correlation of each gene is one matrix-vector product. Genes with constant
+// expression get a zero row and correlation 0.
+struct CorrelationModel {
+    Eigen::MatrixXd standardized;   // genes x samples
+    Eigen::VectorXd phenotype;
+};
+
+// Uses the phenotype samples found in the expression columns. Throws if
+// fewer than three match or the phenotype is constant over them.
+[[nodiscard]] CorrelationModel make_correlation_model(const ExpressionData& expression,
+                                                      const ContinuousPhenotype& phenotype,
+                                                      CorrelationMethod method);
+
+[[nodiscard]] Eigen::VectorXd compute_gene_correlations(const CorrelationModel& model);
+
+// Genes by descending correlation, ties broken by ascending gene index.
+[[nodiscard]] vector<size_t> compute_correlation_rank(const CorrelationModel& model,
+                                                      bool parallel = false);
+
+// Permutation-major null as compute_null_distribution, from sample_size
+// shuffles of the phenotype. Permutations are correlated up to block_size at
+// a time with one matrix-matrix product; blocks run in parallel.
+void compute_correlation_null_distribution(const CorrelationModel& model,
+                                           span<const GeneSet> gene_sets,
+                                           size_t sample_size,
+                                           span<double> null_distribution,
+                                           size_t block_size = 128);
+
+} // namespace gsea
\ No newline at end of file
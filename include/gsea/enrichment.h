@@ -2,6 +2,7 @@
 
 #include "types/gene_set.h"
 #include <Eigen/Dense>
+#include <cstdint>
 #include <span>
 
 using namespace std;
@@ -16,4 +17,29 @@ namespace gsea {
         const GeneSet& gene_set,
         span<const size_t> gene_rank);
 
+    // Score of a set whose members sit at the given rank positions; sorts
+    // hits in place.
+    [[nodiscard]] double enrichment_score_from_hits(
+        span<uint32_t> hits,
+        double up_score,
+        double down_score);
+
+    // As above, for hits already in ascending order.
+    [[nodiscard]] double enrichment_score_from_sorted_hits(
+        span<const uint32_t> hits,
+        double up_score,
+        double down_score);
+
+    // Scores a set from the rank position of each gene (see invert_gene_rank)
+    // by visiting only its members, so the cost is O(k log k) in set size.
+    [[nodiscard]] double calculate_enrichment_score_at(
+        const GeneSet& gene_set,
+        span<const uint32_t> gene_position);
+
+    // Scores every set against one ranking into a caller-owned buffer.
+    void score_gene_sets(
+        span<const GeneSet> gene_sets,
+        span<const size_t> gene_rank,
+        span<double> scores);
+
 } // namespace gsea
\ No newline at end of file
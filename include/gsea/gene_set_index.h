@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types/gene_set.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+// Gene set collection flattened for repeated scoring. Members of every set
+// share one contiguous array, set s owning members[offsets[s], offsets[s + 1]),
+// next to per-set weights; sets are laid out by ascending size. Scoring all
+// sets against one ranking is then a single linear pass over the index.
+//
+// The scoring kernel needs each set's hit positions in ascending order. When
+// the collection holds enough members relative to the genes, the index also
+// lists each gene's memberships, and one walk down the ranking appends every
+// hit to its set already in order; otherwise each set's hits are gathered and
+// sorted. Scratch buffers are kept per thread.
+class GeneSetIndex {
+public:
+    explicit GeneSetIndex(span<const GeneSet> gene_sets);
+
+    [[nodiscard]] size_t num_sets() const noexcept { return set_order_.size(); }
+    [[nodiscard]] size_t num_genes() const noexcept { return num_genes_; }
+
+    // Scores every set from the rank position of each gene (see
+    // invert_gene_rank), into scores in the original gene set order. An
+    // index of no sets accepts any ranking and scores nothing.
+    void score(span<const uint32_t> gene_position, span<double> scores) const;
+
+    // Inverts the ranking once, then scores as above.
+    void score_ranking(span<const size_t> gene_rank, span<double> scores) const;
+
+private:
+    template <typename Index>
+    void score_by_rank(span<const Index> gene_rank, span<double> scores) const;
+    void score_by_gather(span<const uint32_t> gene_position, span<double> scores) const;
+
+    vector<uint32_t> offsets_;
+    vector<uint32_t> members_;
+    vector<double> up_scores_;
+    vector<double> down_scores_;
+    vector<uint32_t> set_order_;   // original index of each indexed set
+    size_t max_set_size_ = 0;
+    size_t num_genes_ = 0;
+
+    // Indexed sets containing gene g: gene_sets_[gene_offsets_[g], gene_offsets_[g + 1])
+    bool scan_ranking_ = false;
+    vector<uint32_t> gene_offsets_;
+    vector<uint32_t> gene_sets_;
+};
+
+} // namespace gsea
\ No newline at end of file
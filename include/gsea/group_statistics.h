@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include "types/sample_data.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+// Per-gene running sums over the disease and healthy groups. Sums of squares
+// are kept alongside so variance-based metrics can be derived without
+// revisiting the samples.
+struct GroupStatistics {
+    vector<string> gene_names;
+    vector<string> sample_names;       // samples accumulated so far
+    vector<uint8_t> disease_status;    // label of each accumulated sample
+    vector<uint64_t> fingerprints;     // raw column text of each, see ColumnFingerprints
+    vector<double> disease_sum;
+    vector<double> healthy_sum;
+    vector<double> disease_sum_sq;
+    vector<double> healthy_sum_sq;
+    size_t num_diseased = 0;
+    size_t num_healthy = 0;
+
+    [[nodiscard]] size_t num_genes() const noexcept { return gene_names.size(); }
+};
+
+// Empty statistics over the given genes.
+[[nodiscard]] GroupStatistics make_group_statistics(span<const string> gene_names);
+
+// Adds every labelled sample of expression that is not yet accumulated, in
+// sample-file order, recording column_fingerprints[column] of each (see
+// ColumnFingerprints::loaded). Returns the number of samples added. Throws
+// invalid_argument if the genes differ, an accumulated sample changed label
+// or there is not one fingerprint per expression column.
+size_t accumulate_samples(GroupStatistics& statistics,
+                          const ExpressionData& expression,
+                          const SampleData& samples,
+                          span<const uint64_t> column_fingerprints);
+
+// True if every accumulated sample still carries the same label in samples.
+[[nodiscard]] bool labels_unchanged(const GroupStatistics& statistics,
+                                    const SampleData& samples);
+
+// True if every accumulated sample is still in the expression file with the
+// same text, given the fingerprints load_expression_data reported when
+// skipping the accumulated sample names.
+[[nodiscard]] bool columns_unchanged(const GroupStatistics& statistics,
+                                     span<const optional<uint64_t>> fingerprints);
+
+// Genes by descending difference of group means, as compute_gene_rank.
+[[nodiscard]] vector<size_t> compute_gene_rank(const GroupStatistics& statistics,
+                                               bool parallel = false);
+
+// Binary cache: "GSEASTA2", counts, gene names, each sample's name, label and
+// fingerprint, then the four per-gene sum vectors. Written to a temporary and renamed into place.
+void save_group_statistics(const string& filepath, const GroupStatistics& statistics);
+
+// nullopt if the file is missing or not a statistics cache.
+[[nodiscard]] optional<GroupStatistics> load_group_statistics(const string& filepath);
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include "types/sample_data.h"
+#include "types/gene_set.h"
+#include "data_loader/geneset_loader.h"
+#include "gsea/statistics.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+struct Cohort {
+    ExpressionData expression;
+    SampleData samples;
+};
+
+enum class MetaMethod {
+    Stouffer,   // sqrt(cohort size)-weighted sum of z-scores
+    Fisher,     // -2 sum log p, chi-squared on 2k degrees of freedom
+    MeanNES     // mean normalised score, tested against the mean of the nulls
+};
+
+// Gene sets resolved once against the union of cohort gene names, then
+// mapped onto each cohort's rows. cohort_sets[c] holds the sets with enough
+// members in cohort c, and cohort_set_index[c] their index into union_sets.
+struct CohortGeneSets {
+    vector<string> union_genes;
+    vector<GeneSet> union_sets;
+    vector<vector<GeneSet>> cohort_sets;
+    vector<vector<size_t>> cohort_set_index;
+};
+
+[[nodiscard]] CohortGeneSets resolve_cohort_gene_sets(span<const GeneSetRecord> records,
+                                                      span<const Cohort> cohorts,
+                                                      const GeneSetFilter& filter = {});
+
+struct MetaResult {
+    string name;
+    size_t num_cohorts;   // cohorts in which the set was scored
+    double statistic;     // combined z, chi-squared or mean NES
+    double p_value;
+};
+
+// Stouffer or Fisher combination of one set's estimates from several cohorts,
+// each from sample_size permutations; num_samples weights the Stouffer
+// z-scores. Returns the combined statistic and its p-value.
+[[nodiscard]] pair<double, double> combine_p_values(span<const PValueEstimate> estimates,
+                                                    span<const size_t> num_samples,
+                                                    size_t sample_size,
+                                                    MetaMethod method);
+
+// Runs ranking and sample_size permutations for every cohort concurrently,
+// then combines the per-set results across cohorts, in union_sets order.
+// Empirical p-values of zero are taken as 1 / (sample_size + 1) for the
+// Stouffer and Fisher combinations, while tail-approximated p-values are
+// used as they are; Stouffer caps p at 1 - 1 / (sample_size + 1) to keep z
+// finite.
+[[nodiscard]] vector<MetaResult> run_meta_analysis(span<const Cohort> cohorts,
+                                                   const CohortGeneSets& gene_sets,
+                                                   size_t sample_size,
+                                                   MetaMethod method,
+                                                   bool tail_approximation = false);
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include "types/gene_set.h"
+#include <vector>
+#include <span>
+
+using namespace std;
+
+namespace gsea {
+
+struct NumaNode {
+    int id;
+    size_t num_cpus;
+};
+
+// Nodes with at least one usable CPU. A single node is reported when libnuma
+// is unavailable or the machine is not NUMA.
+[[nodiscard]] vector<NumaNode> numa_topology();
+
+// Same contract as compute_null_distribution, but permutation blocks are
+// assigned per node, workers are pinned to their node, and each node scores
+// against its own replica of the expression matrix and gene sets. Falls back
+// to compute_null_distribution on single-node machines.
+void compute_null_distribution_numa(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    size_t disease_size,
+    size_t sample_size,
+    span<double> null_distribution);
+
+// The multi-node path over an explicit topology: blocks of permutations
+// proportional to each node's CPU count, num_cpus workers per node. Nodes
+// unknown to libnuma, or every node when it is unavailable, run unpinned.
+// Rethrows the first exception raised by any worker.
+void compute_null_distribution_on_nodes(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    size_t disease_size,
+    size_t sample_size,
+    span<const NumaNode> nodes,
+    span<double> null_distribution);
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "types/gene_set.h"
+#include "types/score_matrix.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+using IntersectionMatrix =
+    Eigen::Matrix<uint32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+enum class OverlapMetric {
+    Jaccard,             // |A & B| / |A | B|
+    OverlapCoefficient,  // |A & B| / min(|A|, |B|)
+};
+
+// All-pairs intersection sizes of sets resolved against the same genes; the
+// diagonal holds the set sizes. Membership is bit-packed over the genes and
+// pairs are counted with popcount over cache-blocked tiles of sets, using
+// the POPCNT instruction on x86 CPUs that have it.
+[[nodiscard]] IntersectionMatrix compute_intersections(span<const GeneSet> gene_sets);
+
+[[nodiscard]] ScoreMatrix compute_similarity(const IntersectionMatrix& intersections,
+                                             OverlapMetric metric);
+
+// Greedy redundancy filter: visits sets from largest to smallest and keeps a
+// set only if its similarity to every set kept so far is below threshold.
+// Returns the kept indices in ascending order.
+[[nodiscard]] vector<size_t> select_nonredundant_sets(span<const GeneSet> gene_sets,
+                                                      double threshold,
+                                                      OverlapMetric metric);
+
+// For each set, the index of the first set with exactly the same members
+// (itself if there is none), so identical sets can be scored once.
+[[nodiscard]] vector<size_t> find_identical_sets(span<const GeneSet> gene_sets);
+
+} // namespace gsea
\ No newline at end of file
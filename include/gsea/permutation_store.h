@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include "types/gene_set.h"
+#include <cstdint>
+#include <span>
+#include <string>
+
+using namespace std;
+
+namespace gsea {
+
+// Identifies the inputs a label-permutation null depends on: the expression
+// values, gene names and the size of the disease group.
+[[nodiscard]] uint64_t fingerprint_permutation_inputs(const ExpressionData& expression,
+                                                      size_t disease_size);
+
+// Memory-mapped file of seeded label permutations, stored as the rank position
+// of every gene (uint16 when the genes fit, else uint32). Rankings do not
+// depend on gene sets, so new collections or thresholds can be scored against
+// a stored null without re-ranking. Files live in one directory, named by
+// input fingerprint and seed:
+//   char[8] "GSEAPRM1", uint64 fingerprint, seed, num_genes, num_permutations,
+//   uint32 bytes per index, uint32 reserved, then one row per permutation.
+class PermutationStore {
+public:
+    // Opens the store for these inputs and seed, first generating and
+    // appending permutations until it holds at least sample_size of them.
+    // Concurrent opens, from threads or processes, take turns on a
+    // "<store>.lock" file while they check and extend the store.
+    static PermutationStore open(const string& directory,
+                                 const ExpressionData& expression,
+                                 size_t disease_size,
+                                 uint64_t seed,
+                                 size_t sample_size);
+
+    ~PermutationStore();
+    PermutationStore(PermutationStore&& other) noexcept;
+    PermutationStore& operator=(PermutationStore&& other) noexcept;
+    PermutationStore(const PermutationStore&) = delete;
+    PermutationStore& operator=(const PermutationStore&) = delete;
+
+    [[nodiscard]] size_t num_genes() const noexcept { return num_genes_; }
+    [[nodiscard]] size_t num_permutations() const noexcept { return num_permutations_; }
+
+    // Rank position of each gene under one permutation
+    void gene_positions(size_t permutation, span<uint32_t> positions) const;
+
+    // Fills the first sample_size rows of a permutation-major null
+    // distribution, as compute_null_distribution does.
+    void score(span<const GeneSet> gene_sets,
+               size_t sample_size,
+               span<double> null_distribution) const;
+
+private:
+    PermutationStore() = default;
+    void unmap() noexcept;
+
+    const unsigned char* data_ = nullptr;   // first permutation row
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    size_t num_genes_ = 0;
+    size_t num_permutations_ = 0;
+    uint32_t index_bytes_ = 0;
+};
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+using namespace std;
+
+namespace gsea {
+
+// Maps doubles to unsigned keys with the same order (a < b implies
+// order_key(a) < order_key(b)); -0.0 and 0.0 map to the same key.
+[[nodiscard]] uint64_t order_key(double value) noexcept;
+
+// Writes into order the indices of scores sorted by descending score, ties
+// broken by ascending index. LSD radix sort over 11-bit digits of the order
+// keys; digit passes where every key agrees are skipped. With parallel set,
+// each pass histograms and scatters per-thread chunks, and the result is
+// identical to the sequential sort.
+void radix_sort_descending(span<const double> scores,
+                           span<uint32_t> order,
+                           bool parallel = false);
+
+} // namespace gsea
\ No newline at end of file
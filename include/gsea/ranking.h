@@ -1,6 +1,7 @@
 #pragma once
 
 #include "types/expression_data.h"
+#include <cstdint>
 #include <vector>
 #include <span>
 
@@ -8,9 +9,24 @@ using namespace std;
 
 namespace gsea {
 
+// Genes by descending difference of group means, ties broken by ascending
+// gene index so rankings are reproducible. Set parallel for one-off
+// rankings; permutation workers rank single-threaded.
 [[nodiscard]] vector<size_t> compute_gene_rank(
     const ExpressionData& expression,
     span<const size_t> disease_indices,
-    span<const size_t> healthy_indices);
+    span<const size_t> healthy_indices,
+    bool parallel = false);
+
+// Writes the ranking into a caller-owned buffer of num_genes entries.
+void compute_gene_rank(
+    const ExpressionData& expression,
+    span<const size_t> disease_indices,
+    span<const size_t> healthy_indices,
+    span<size_t> ranked_indices,
+    bool parallel = false);
+
+// Inverse of a ranking: gene_position[gene_rank[i]] == i.
+void invert_gene_rank(span<const size_t> gene_rank, span<uint32_t> gene_position);
 
 } // namespace gsea
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include "types/gene_set.h"
+#include "types/score_matrix.h"
+#include <span>
+
+using namespace std;
+
+namespace gsea {
+
+// Single-sample GSEA (Barbie et al., 2009): genes are ranked within each
+// sample, and each set scores the sum over ranked positions of the weighted
+// hit fraction minus the miss fraction, hits weighted by rank^alpha. Returns
+// a samples x sets matrix; samples are processed in parallel blocks and each
+// set is evaluated from its members' rank positions only.
+[[nodiscard]] ScoreMatrix compute_ssgsea(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    double alpha = 0.25);
+
+// Scores one set from the descending-rank position of each gene.
+[[nodiscard]] double calculate_ssgsea_score(
+    const GeneSet& gene_set,
+    span<const uint32_t> gene_position,
+    double alpha);
+
+} // namespace gsea
\ No newline at end of file
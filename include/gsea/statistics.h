@@ -2,6 +2,9 @@
 
 #include "types/expression_data.h"
 #include "types/gene_set.h"
+#include "gsea/tail_approximation.h"
+#include <optional>
+#include <cstdint>
 #include <vector>
 #include <span>
 
@@ -13,16 +16,73 @@ namespace gsea {
     const ExpressionData& expression,
     size_t disease_size);
 
-[[nodiscard]] vector<vector<double>> compute_null_distribution(
+// Reproducible variant: permutation number `permutation` of the stream
+// identified by seed, independent of thread count and evaluation order.
+[[nodiscard]] vector<size_t> generate_random_gene_rank(
+    const ExpressionData& expression,
+    size_t disease_size,
+    uint64_t seed,
+    uint64_t permutation);
+
+// Null enrichment scores in permutation-major order: entry
+// [sample * gene_sets.size() + set] is the score of set under permutation
+// sample.
+[[nodiscard]] vector<double> compute_null_distribution(
     const ExpressionData& expression,
     span<const GeneSet> gene_sets,
     size_t disease_size,
     size_t sample_size);
 
+// Fills a caller-owned buffer of sample_size * gene_sets.size() scores.
+void compute_null_distribution(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    size_t disease_size,
+    size_t sample_size,
+    span<double> null_distribution);
+
+enum class PValueMethod {
+    Empirical,   // count_greater / sample_size
+    Pareto,      // generalised Pareto tail fit
+    Bound        // beyond the fitted tail's endpoint: (count_greater + 1) / (sample_size + 1)
+};
+
+struct PValueEstimate {
+    double p_value;
+    size_t count_greater;      // null scores >= the observed score
+    optional<TailFit> tail;    // accepted tail fit, for Pareto and Bound
+    PValueMethod method = PValueMethod::Empirical;
+};
+
+// Empirical p-values, count_greater / sample_size. With tail_approximation,
+// sets with fewer than 10 null exceedances are instead scored from a
+// generalised Pareto fit to the top of their null, when one is accepted. A
+// score past the upper endpoint of a bounded fit has no tail mass; it gets
+// the conservative bound (count_greater + 1) / (sample_size + 1) instead.
+[[nodiscard]] vector<PValueEstimate> estimate_p_values(
+    span<const double> actual_scores,
+    span<const double> null_distribution,
+    size_t num_sets,
+    bool tail_approximation = false);
+
+// Inverse of the standard normal CDF, for p in (0, 1).
+[[nodiscard]] double normal_quantile(double p);
+
+struct ConfidenceInterval {
+    double lower;
+    double upper;
+};
+
+// Wilson score interval for a proportion of count out of n, e.g. an
+// empirical p-value after n permutations.
+[[nodiscard]] ConfidenceInterval wilson_interval(size_t count, size_t n,
+                                                 double confidence = 0.99);
+
 [[nodiscard]] vector<size_t> find_significant_sets(
     span<const double> actual_scores,
-    span<const vector<double>> null_distribution,
+    span<const double> null_distribution,
     double p_value,
-    size_t num_sets);
+    size_t num_sets,
+    bool tail_approximation = false);
 
 } // namespace gsea
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <optional>
+#include <span>
+
+using namespace std;
+
+namespace gsea {
+
+// Generalised Pareto fit to the upper tail of a null distribution, following
+// Knijnenburg et al. (2009): the exceedances over threshold are modelled as
+// GPD(shape, scale), so P(X > x) ~ (exceedances / n) * S(x - threshold).
+struct TailFit {
+    double threshold;
+    double shape;
+    double scale;
+    size_t exceedances;
+    size_t null_size;
+    double ad_statistic;   // Anderson-Darling statistic of the accepted fit
+    double ad_p_value;     // parametric bootstrap p-value of ad_statistic
+};
+
+// Fits the tail of one set's null scores, lowering the number of exceedances
+// from min(250, n / 4) in steps of 10 until the Anderson-Darling test no
+// longer rejects at the 5% level. Returns nullopt if no fit is accepted.
+[[nodiscard]] optional<TailFit> fit_pareto_tail(span<const double> null_scores);
+
+// Tail probability P(X >= score) under the fit; score should be above the
+// threshold. Returns 0 past the upper endpoint of a bounded (shape < 0) tail.
+[[nodiscard]] double pareto_tail_p_value(const TailFit& fit, double score);
+
+} // namespace gsea
\ No newline at end of file
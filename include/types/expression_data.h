@@ -10,12 +10,26 @@ using namespace std;
 
 namespace gsea {
 
+// Column-major genes x samples matrix, possibly with padding between columns.
+using MatrixView = Eigen::Map<const Eigen::MatrixXd, 0, Eigen::OuterStride<>>;
+
 class ExpressionData {
 public:
     ExpressionData(Eigen::MatrixXd values,
                    vector<string> gene_names,
                    vector<string> sample_names);
 
+    // Non-owning view over caller memory, which must outlive this object
+    // and every copy of it.
+    ExpressionData(MatrixView values,
+                   span<const string> gene_names,
+                   span<const string> sample_names);
+
+    ExpressionData(const ExpressionData& other);
+    ExpressionData(ExpressionData&&) noexcept = default;
+    ExpressionData& operator=(const ExpressionData& other);
+    ExpressionData& operator=(ExpressionData&&) noexcept = default;
+
     [[nodiscard]] size_t num_genes() const noexcept { return gene_names_.size(); }
     [[nodiscard]] size_t num_samples() const noexcept { return sample_names_.size(); }
 
@@ -23,14 +37,26 @@ public:
     [[nodiscard]] optional<string_view> sample_name(size_t index) const noexcept;
     [[nodiscard]] optional<double> get_value(size_t gene_idx, size_t sample_idx) const noexcept;
 
-    [[nodiscard]] const Eigen::MatrixXd& values() const noexcept { return values_; }
+    [[nodiscard]] MatrixView values() const noexcept {
+        return {data_, static_cast<Eigen::Index>(num_genes()),
+                static_cast<Eigen::Index>(num_samples()), Eigen::OuterStride<>(stride_)};
+    }
     [[nodiscard]] span<const string> gene_names() const noexcept { return gene_names_; }
     [[nodiscard]] span<const string> sample_names() const noexcept { return sample_names_; }
 
 private:
-    Eigen::MatrixXd values_;
-    vector<string> gene_names_;
-    vector<string> sample_names_;
+    void bind_owned() noexcept;
+
+    // Backing storage when the data was loaded rather than borrowed
+    Eigen::MatrixXd owned_values_;
+    vector<string> owned_gene_names_;
+    vector<string> owned_sample_names_;
+
+    bool owning_ = false;
+    const double* data_;
+    Eigen::Index stride_;
+    span<const string> gene_names_;
+    span<const string> sample_names_;
 };
 
 } // namespace gsea
\ No newline at end of file
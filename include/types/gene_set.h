@@ -1,6 +1,8 @@
 #pragma once
 
-#include <Eigen/Dense>
+#include <cstdint>
+#include <vector>
+#include <span>
 #include <string>
 #include <optional>
 #include <string_view>
@@ -9,20 +11,39 @@ using namespace std;
 
 namespace gsea {
 
+// A gene set resolved against an expression matrix of num_genes rows. Members
+// are distinct row indices; ranked members score up_score() and every other
+// gene scores down_score() in the running enrichment sum.
 class GeneSet {
 public:
-    GeneSet(string name, size_t gene_count, Eigen::VectorXd scores);
+    GeneSet(string name, vector<uint32_t> members, size_t num_genes);
 
-    [[nodiscard]] size_t size() const noexcept { return gene_count_; }
+    // Non-owning view over caller-held member indices, which must outlive
+    // this object and every copy of it.
+    GeneSet(string name, span<const uint32_t> members, size_t num_genes);
+
+    GeneSet(const GeneSet& other);
+    GeneSet(GeneSet&&) noexcept = default;
+    GeneSet& operator=(const GeneSet& other);
+    GeneSet& operator=(GeneSet&&) noexcept = default;
+
+    [[nodiscard]] size_t size() const noexcept { return members_.size(); }
+    [[nodiscard]] size_t num_genes() const noexcept { return num_genes_; }
     [[nodiscard]] optional<double> get_score(size_t gene_idx) const noexcept;
     [[nodiscard]] string_view get_name() const noexcept { return name_; }
 
-    [[nodiscard]] const Eigen::VectorXd& scores() const noexcept { return scores_; }
+    [[nodiscard]] span<const uint32_t> members() const noexcept { return members_; }
+    [[nodiscard]] double up_score() const noexcept { return up_score_; }
+    [[nodiscard]] double down_score() const noexcept { return down_score_; }
 
 private:
     string name_;
-    size_t gene_count_;
-    Eigen::VectorXd scores_;
+    vector<uint32_t> owned_members_;
+    bool owning_ = false;
+    span<const uint32_t> members_;
+    size_t num_genes_;
+    double up_score_;
+    double down_score_;
 };
 
 } // namespace gsea
\ No newline at end of file
@@ -14,6 +14,16 @@ public:
     SampleData(vector<string> sample_names,
                vector<uint8_t> disease_status);
 
+    // Non-owning view over caller memory, which must outlive this object
+    // and every copy of it.
+    SampleData(span<const string> sample_names,
+               span<const uint8_t> disease_status);
+
+    SampleData(const SampleData& other);
+    SampleData(SampleData&&) noexcept = default;
+    SampleData& operator=(const SampleData& other);
+    SampleData& operator=(SampleData&&) noexcept = default;
+
     [[nodiscard]] size_t num_samples() const noexcept { return sample_names_.size(); }
     [[nodiscard]] size_t num_diseased() const noexcept;
     [[nodiscard]] size_t num_healthy() const noexcept;
@@ -28,8 +38,15 @@ public:
     [[nodiscard]] span<const uint8_t> disease_status() const noexcept { return disease_status_; }
 
 private:
-    vector<string> sample_names_;
-    vector<uint8_t> disease_status_;
+    void bind_owned() noexcept;
+
+    // Backing storage when the data was loaded rather than borrowed
+    vector<string> owned_sample_names_;
+    vector<uint8_t> owned_disease_status_;
+
+    bool owning_ = false;
+    span<const string> sample_names_;
+    span<const uint8_t> disease_status_;
 };
 
 } // namespace gsea
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace gsea {
+
+// Dense scores with one row per sample (or set) and one column per set,
+// stored row-major so each row is contiguous.
+using ScoreMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+} // namespace gsea
\ No newline at end of file
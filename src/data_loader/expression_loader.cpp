@@ -1,8 +1,9 @@
 #include "data_loader/expression_loader.h"
-#include <fstream>
+#include "data_loader/input_stream.h"
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
+#include <unordered_map>
 
 using namespace std;
 
@@ -25,8 +26,26 @@ static string trim(const string& str) {
     return str.substr(start, end - start + 1);
 }
 
-ExpressionData load_expression_data(const string& filepath) {
-    ifstream file(filepath);
+static double parse_value(const string& token) {
+    try {
+        return stod(token);
+    } catch ([[maybe_unused]] const exception& e) {
+        throw runtime_error("Failed to parse expression value: " + token);
+    }
+}
+
+static uint64_t fingerprint_token(uint64_t hash, const string& token) {
+    for (unsigned char byte : token) {
+        hash = (hash ^ byte) * 0x100000001b3ULL;
+    }
+    // Separator, so that tokens "1" "23" and "12" "3" differ
+    return (hash ^ '\t') * 0x100000001b3ULL;
+}
+
+static ExpressionData load_columns(const string& filepath,
+                                   span<const string> skip_samples,
+                                   ColumnFingerprints& fingerprints) {
+    InputStream file(filepath);
     if (!file) {
         throw runtime_error("Failed to open expression file: " + filepath);
     }
@@ -43,11 +62,28 @@ ExpressionData load_expression_data(const string& filepath) {
         throw runtime_error("Expression file must have at least 2 columns");
     }
 
+    unordered_map<string_view, size_t> skipped;
+    for (size_t i = 0; i < skip_samples.size(); ++i) {
+        skipped.emplace(skip_samples[i], i);
+    }
+
     // Extract sample names (skip first column "SYMBOL")
     vector<string> sample_names;
+    vector<size_t> columns;
+    vector<pair<size_t, size_t>> skipped_columns;   // column, skip_samples index
     for (size_t i = 1; i < headers.size(); ++i) {
-        sample_names.push_back(trim(headers[i]));
+        auto name = trim(headers[i]);
+        if (auto it = skipped.find(name); it != skipped.end()) {
+            skipped_columns.emplace_back(i, it->second);
+        } else {
+            sample_names.push_back(std::move(name));
+            columns.push_back(i);
+        }
     }
+    constexpr uint64_t kFingerprintBasis = 0xcbf29ce484222325ULL;
+    vector<uint64_t> loaded_hashes(columns.size(), kFingerprintBasis);
+    vector<uint64_t> skipped_hashes(skipped_columns.size(), kFingerprintBasis);
+    size_t num_columns = headers.size() - 1;
     size_t num_samples = sample_names.size();
 
     // Read data
@@ -58,23 +94,30 @@ ExpressionData load_expression_data(const string& filepath) {
         if (line.empty()) continue;
         
         auto tokens = split(line, '\t');
-        if (tokens.size() != num_samples + 1) {
+        if (tokens.size() != num_columns + 1) {
             throw runtime_error(
                 "Inconsistent number of columns at gene: " + tokens[0]);
         }
 
         gene_names.push_back(trim(tokens[0]));
 
-        for (size_t i = 1; i < tokens.size(); ++i) {
-            try {
-                values.push_back(stod(tokens[i]));
-            } catch ([[maybe_unused]] const exception& e) {
-                throw runtime_error(
-                    "Failed to parse expression value: " + tokens[i]);
-            }
+        for (size_t k = 0; k < columns.size(); ++k) {
+            const auto& token = tokens[columns[k]];
+            values.push_back(parse_value(token));
+            loaded_hashes[k] = fingerprint_token(loaded_hashes[k], token);
+        }
+        for (size_t k = 0; k < skipped_columns.size(); ++k) {
+            skipped_hashes[k] = fingerprint_token(skipped_hashes[k],
+                                                  tokens[skipped_columns[k].first]);
         }
     }
 
+    fingerprints.loaded = std::move(loaded_hashes);
+    fingerprints.skipped.assign(skip_samples.size(), nullopt);
+    for (size_t k = 0; k < skipped_columns.size(); ++k) {
+        fingerprints.skipped[skipped_columns[k].second] = skipped_hashes[k];
+    }
+
     size_t num_genes = gene_names.size();
     if (num_genes == 0) {
         throw runtime_error("Expression file contains no gene rows");
@@ -91,4 +134,15 @@ ExpressionData load_expression_data(const string& filepath) {
     return {std::move(matrix), std::move(gene_names), std::move(sample_names)};
 }
 
+ExpressionData load_expression_data(const string& filepath) {
+    ColumnFingerprints fingerprints;
+    return load_columns(filepath, {}, fingerprints);
+}
+
+ExpressionData load_expression_data(const string& filepath,
+                                    span<const string> skip_samples,
+                                    ColumnFingerprints& fingerprints) {
+    return load_columns(filepath, skip_samples, fingerprints);
+}
+
 } // namespace gsea
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "data_loader/geneset_loader.h"
+#include "data_loader/input_stream.h"
+#include "data_loader/gmt_index.h"
+#include <algorithm>
 #include <fstream>
+#include <optional>
+#include <regex>
 #include <stdexcept>
-#include <unordered_set>
+#include <unordered_map>
 #include <iostream>
-#include <cmath>
 #include <string_view>
 #include <format>
 
@@ -34,74 +38,143 @@ static string trim(string_view str) {
     return string(str.substr(start, end - start + 1));
 }
 
-vector<GeneSet> load_gene_sets(const string& filepath,
-                                     const vector<string>& gene_names) {
-    ifstream file(filepath);
-    if (!file) {
-        throw runtime_error(format("Failed to open gene set file: {}", filepath));
+static bool name_selected(string_view name,
+                          const GeneSetFilter& filter,
+                          const optional<regex>& pattern) {
+    if (!name.starts_with(filter.name_prefix)) {
+        return false;
     }
+    return !pattern || regex_match(name.begin(), name.end(), *pattern);
+}
 
-    size_t num_genes = gene_names.size();
-    vector<GeneSet> gene_sets;
+static optional<GeneSetRecord> parse_record(string_view line, size_t line_num) {
+    auto tokens = split(line, '\t');
+    if (tokens.size() < 3) {
+        cerr << format("Warning: Skipping line {} in gene set file: insufficient columns\n",
+            line_num);
+        return nullopt;
+    }
 
-    string line;
-    size_t line_num = 0;
+    GeneSetRecord record{trim(tokens[0]), line_num, {}};
 
-    while (getline(file, line)) {
-        ++line_num;
-        if (line.empty()) continue;
+    // Collect gene symbols (skip name and description columns)
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        auto gene = trim(tokens[i]);
+        if (!gene.empty()) {
+            record.genes.push_back(std::move(gene));
+        }
+    }
 
-        auto tokens = split(line, '\t');
-        if (tokens.size() < 3) {
-            cerr << format("Warning: Skipping line {} in gene set file: insufficient columns\n",
-                line_num);
-            continue;
+    if (record.genes.empty()) {
+        cerr << format("Warning: Skipping gene set '{}': contains no genes\n", record.name);
+        return nullopt;
+    }
+
+    return record;
+}
+
+vector<GeneSetRecord> read_gene_set_records(const string& filepath,
+                                            const GeneSetFilter& filter) {
+    optional<regex> pattern;
+    if (!filter.name_pattern.empty()) {
+        pattern.emplace(filter.name_pattern);
+    }
+
+    vector<GeneSetRecord> records;
+
+    bool name_filtered = !filter.name_prefix.empty() || pattern.has_value();
+    if (!name_filtered || is_compressed_file(filepath)) {
+        // Every entry is wanted, or there is no random access into
+        // compressed input: stream and filter
+        InputStream file(filepath);
+        if (!file) {
+            throw runtime_error(format("Failed to open gene set file: {}", filepath));
         }
 
-        string set_name = trim(tokens[0]);
+        string line;
+        size_t line_num = 0;
 
-        // Build set of genes (skip name and description columns)
-        unordered_set<string> genes_in_set;
-        for (size_t i = 2; i < tokens.size(); ++i) {
-            auto gene = trim(tokens[i]);
-            if (!gene.empty()) {
-                genes_in_set.insert(std::move(gene));
+        while (getline(file, line)) {
+            ++line_num;
+            if (line.empty()) continue;
+
+            string_view name = string_view(line).substr(0, line.find('\t'));
+            if (!name_selected(trim(name), filter, pattern)) continue;
+
+            if (auto record = parse_record(line, line_num)) {
+                records.push_back(std::move(*record));
             }
         }
+    } else {
+        auto index = load_gmt_index(filepath);
 
-        if (genes_in_set.empty()) {
-            cerr << format("Warning: Skipping gene set '{}': contains no genes\n", set_name);
-            continue;
+        ifstream file(filepath, ios::binary);
+        if (!file) {
+            throw runtime_error(format("Failed to open gene set file: {}", filepath));
+        }
+
+        string line;
+        for (const auto& entry : index) {
+            // Size bounds wait for resolution: a symbol on several
+            // expression rows matches all of them
+            if (!name_selected(entry.name, filter, pattern)) {
+                continue;
+            }
+
+            line.resize(entry.length);
+            file.seekg(static_cast<streamoff>(entry.offset));
+            if (!file.read(line.data(), entry.length)) {
+                throw runtime_error(format(
+                    "Gene set file changed while reading line {}", entry.line_num));
+            }
+
+            if (auto record = parse_record(line, entry.line_num)) {
+                records.push_back(std::move(*record));
+            }
         }
+    }
+
+    return records;
+}
+
+vector<GeneSet> resolve_gene_sets(span<const GeneSetRecord> records,
+                                  span<const string> gene_names,
+                                  const GeneSetFilter& filter) {
+    size_t num_genes = gene_names.size();
 
-        // Create boolean mask and count genes
-        vector<bool> gene_mask;
-        gene_mask.reserve(num_genes);
-        size_t gene_count = 0;
+    // A symbol that appears on several expression rows matches all of them
+    unordered_multimap<string_view, uint32_t> lookup;
+    lookup.reserve(num_genes);
+    for (size_t i = 0; i < num_genes; ++i) {
+        lookup.emplace(gene_names[i], static_cast<uint32_t>(i));
+    }
+
+    vector<GeneSet> gene_sets;
 
-        for (const auto& gene : gene_names) {
-            bool in_set = genes_in_set.contains(gene);
-            gene_mask.push_back(in_set);
-            if (in_set) ++gene_count;
+    for (const auto& record : records) {
+        vector<uint32_t> members;
+        for (const auto& gene : record.genes) {
+            auto [first, last] = lookup.equal_range(gene);
+            for (auto it = first; it != last; ++it) {
+                members.push_back(it->second);
+            }
         }
 
-        if (gene_count == 0) {
+        ranges::sort(members);
+        auto duplicates = ranges::unique(members);
+        members.erase(duplicates.begin(), duplicates.end());
+
+        if (members.empty()) {
             cerr << format("Warning: Skipping gene set '{}': no genes match expression data\n",
-                set_name);
+                record.name);
             continue;
         }
 
-        // Precompute scores
-        double up_score;
-        up_score = sqrt(static_cast<double>(num_genes - gene_count) / gene_count);
-        double down_score = -1.0 / up_score;
-
-        Eigen::VectorXd scores(num_genes);
-        for (size_t i = 0; i < num_genes; ++i) {
-            scores(i) = gene_mask[i] ? up_score : down_score;
+        if (members.size() < filter.min_size || members.size() > filter.max_size) {
+            continue;
         }
 
-        gene_sets.emplace_back(std::move(set_name), gene_count, std::move(scores));
+        gene_sets.emplace_back(record.name, std::move(members), num_genes);
     }
 
     if (gene_sets.empty()) {
@@ -111,4 +184,10 @@ vector<GeneSet> load_gene_sets(const string& filepath,
     return gene_sets;
 }
 
+vector<GeneSet> load_gene_sets(const string& filepath,
+                                     span<const string> gene_names,
+                                     const GeneSetFilter& filter) {
+    return resolve_gene_sets(read_gene_set_records(filepath, filter), gene_names, filter);
+}
+
 } // namespace gsea
\ No newline at end of file
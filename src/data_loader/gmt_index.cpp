@@ -0,0 +1,165 @@
+#include "data_loader/gmt_index.h"
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr array<char, 8> kIndexMagic = {'G', 'S', 'E', 'A', 'G', 'M', 'T', '2'};
+
+struct SourceStamp {
+    uint64_t size;
+    int64_t mtime;
+
+    bool operator==(const SourceStamp&) const = default;
+};
+
+static SourceStamp source_stamp(const string& filepath) {
+    auto path = filesystem::path(filepath);
+    return {filesystem::file_size(path),
+            static_cast<int64_t>(filesystem::last_write_time(path).time_since_epoch().count())};
+}
+
+template <typename T>
+static void write_pod(ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool read_pod(istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+static vector<GmtIndexEntry> build_index(const string& filepath) {
+    ifstream file(filepath, ios::binary);
+    if (!file) {
+        throw runtime_error(format("Failed to open gene set file: {}", filepath));
+    }
+
+    vector<GmtIndexEntry> entries;
+    string line;
+    uint64_t offset = 0;
+    uint32_t line_num = 0;
+
+    while (getline(file, line)) {
+        ++line_num;
+        uint64_t line_offset = offset;
+        offset += line.size() + 1;
+
+        string_view view = line;
+        if (!view.empty() && view.back() == '\r') {
+            view.remove_suffix(1);
+        }
+        if (view.empty()) continue;
+
+        auto name = view.substr(0, view.find('\t'));
+        auto first = name.find_first_not_of(" \t\r\n");
+        name = first == string_view::npos
+            ? string_view{} : name.substr(first, name.find_last_not_of(" \t\r\n") - first + 1);
+
+        entries.push_back({string(name), line_offset, static_cast<uint32_t>(view.size()),
+                           line_num});
+    }
+
+    return entries;
+}
+
+static optional<vector<GmtIndexEntry>> read_cached_index(const string& index_path,
+                                                         const SourceStamp& stamp) {
+    ifstream in(index_path, ios::binary);
+    if (!in) return nullopt;
+
+    array<char, 8> magic{};
+    SourceStamp cached{};
+    uint64_t count = 0;
+    if (!in.read(magic.data(), magic.size()) || magic != kIndexMagic ||
+        !read_pod(in, cached.size) || !read_pod(in, cached.mtime) || cached != stamp ||
+        !read_pod(in, count) || count > stamp.size) {
+        return nullopt;
+    }
+
+    vector<GmtIndexEntry> entries(count);
+    for (auto& entry : entries) {
+        uint32_t name_length = 0;
+        if (!read_pod(in, entry.offset) || !read_pod(in, entry.length) ||
+            !read_pod(in, entry.line_num) || !read_pod(in, name_length)) {
+            return nullopt;
+        }
+        entry.name.resize(name_length);
+        if (!in.read(entry.name.data(), name_length)) {
+            return nullopt;
+        }
+    }
+
+    return entries;
+}
+
+static bool write_index_file(const string& path,
+                             const SourceStamp& stamp,
+                             const vector<GmtIndexEntry>& entries) {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+
+    out.write(kIndexMagic.data(), kIndexMagic.size());
+    write_pod(out, stamp.size);
+    write_pod(out, stamp.mtime);
+    write_pod(out, static_cast<uint64_t>(entries.size()));
+    for (const auto& entry : entries) {
+        write_pod(out, entry.offset);
+        write_pod(out, entry.length);
+        write_pod(out, entry.line_num);
+        write_pod(out, static_cast<uint32_t>(entry.name.size()));
+        out.write(entry.name.data(), static_cast<streamsize>(entry.name.size()));
+    }
+    out.close();
+    return static_cast<bool>(out);
+}
+
+static void write_cached_index(const string& index_path,
+                               const SourceStamp& stamp,
+                               const vector<GmtIndexEntry>& entries) {
+    // Write to a temporary of our own and rename it into place, so readers
+    // never see a partial index even when several jobs build it at once
+    random_device rd;
+    uint64_t suffix = (static_cast<uint64_t>(rd()) << 32) | rd();
+    string temp_path = format("{}.{:016x}.tmp", index_path, suffix);
+
+    error_code ec;
+    if (!write_index_file(temp_path, stamp, entries)) {
+        filesystem::remove(temp_path, ec);
+        return;
+    }
+    filesystem::rename(temp_path, index_path, ec);
+    if (ec) {
+        filesystem::remove(temp_path, ec);
+    }
+}
+
+vector<GmtIndexEntry> load_gmt_index(const string& filepath) {
+    SourceStamp stamp;
+    try {
+        stamp = source_stamp(filepath);
+    } catch (const filesystem::filesystem_error&) {
+        throw runtime_error(format("Failed to open gene set file: {}", filepath));
+    }
+
+    string index_path = filepath + ".idx";
+    if (auto cached = read_cached_index(index_path, stamp)) {
+        return std::move(*cached);
+    }
+
+    auto entries = build_index(filepath);
+    write_cached_index(index_path, stamp, entries);
+    return entries;
+}
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,344 @@
+#include "data_loader/input_stream.h"
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+#ifdef GSEA_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr size_t kRingSlots = 4;
+static constexpr size_t kSlotBytes = size_t{1} << 20;
+static constexpr size_t kReadBytes = size_t{1} << 18;
+
+// Produces decoded bytes; returns 0 once the input is exhausted.
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+    virtual size_t read(char* out, size_t capacity) = 0;
+};
+
+class PlainDecoder final : public Decoder {
+public:
+    explicit PlainDecoder(FILE* file) : file_(file) {}
+
+    size_t read(char* out, size_t capacity) override {
+        size_t n = fread(out, 1, capacity, file_);
+        if (n == 0 && ferror(file_)) {
+            throw runtime_error("Read error");
+        }
+        return n;
+    }
+
+private:
+    FILE* file_;
+};
+
+class GzipDecoder final : public Decoder {
+public:
+    explicit GzipDecoder(FILE* file) : file_(file), input_(kReadBytes) {
+        // 15 + 32: accept gzip or zlib headers
+        if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+            throw runtime_error("Failed to initialise gzip decoder");
+        }
+    }
+
+    ~GzipDecoder() override { inflateEnd(&stream_); }
+
+    size_t read(char* out, size_t capacity) override {
+        stream_.next_out = reinterpret_cast<Bytef*>(out);
+        stream_.avail_out = static_cast<uInt>(capacity);
+
+        while (stream_.avail_out > 0) {
+            if (stream_.avail_in == 0 && !at_eof_) {
+                size_t n = fread(input_.data(), 1, input_.size(), file_);
+                if (n == 0) {
+                    if (ferror(file_)) throw runtime_error("Read error");
+                    at_eof_ = true;
+                } else {
+                    stream_.next_in = reinterpret_cast<Bytef*>(input_.data());
+                    stream_.avail_in = static_cast<uInt>(n);
+                }
+            }
+
+            if (stream_.avail_in > 0) {
+                member_open_ = true;
+            }
+            uInt avail_out = stream_.avail_out;
+            int status = inflate(&stream_, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                // Concatenated gzip members are decoded as one stream
+                member_open_ = false;
+                inflateReset(&stream_);
+            } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                throw runtime_error(format("gzip decode error: {}",
+                    stream_.msg ? stream_.msg : "corrupt input"));
+            }
+
+            // Out of input with nothing left to flush
+            if (at_eof_ && stream_.avail_in == 0 && stream_.avail_out == avail_out &&
+                status != Z_STREAM_END) {
+                if (member_open_) {
+                    throw runtime_error("truncated gzip input");
+                }
+                break;
+            }
+        }
+
+        return capacity - stream_.avail_out;
+    }
+
+private:
+    FILE* file_;
+    vector<char> input_;
+    z_stream stream_{};
+    bool at_eof_ = false;
+    bool member_open_ = false;   // inside a gzip member not yet ended
+};
+
+#ifdef GSEA_HAVE_ZSTD
+class ZstdDecoder final : public Decoder {
+public:
+    explicit ZstdDecoder(FILE* file)
+        : file_(file), input_(ZSTD_DStreamInSize()), stream_(ZSTD_createDStream()) {
+        if (!stream_) {
+            throw runtime_error("Failed to initialise zstd decoder");
+        }
+    }
+
+    ~ZstdDecoder() override { ZSTD_freeDStream(stream_); }
+
+    size_t read(char* out, size_t capacity) override {
+        ZSTD_outBuffer output{out, capacity, 0};
+
+        while (output.pos < output.size) {
+            if (in_.pos == in_.size && !at_eof_) {
+                size_t n = fread(input_.data(), 1, input_.size(), file_);
+                if (n == 0) {
+                    if (ferror(file_)) throw runtime_error("Read error");
+                    at_eof_ = true;
+                } else {
+                    in_ = ZSTD_inBuffer{input_.data(), n, 0};
+                }
+            }
+
+            size_t before = output.pos;
+            size_t status = ZSTD_decompressStream(stream_, &output, &in_);
+            if (ZSTD_isError(status)) {
+                throw runtime_error(format("zstd decode error: {}",
+                    ZSTD_getErrorName(status)));
+            }
+            // Zero once a frame is fully decoded and flushed
+            frame_open_ = status != 0;
+
+            if (at_eof_ && in_.pos == in_.size && output.pos == before) {
+                if (frame_open_) {
+                    throw runtime_error("truncated zstd input");
+                }
+                break;
+            }
+        }
+
+        return output.pos;
+    }
+
+private:
+    FILE* file_;
+    vector<char> input_;
+    ZSTD_DStream* stream_;
+    ZSTD_inBuffer in_{nullptr, 0, 0};
+    bool at_eof_ = false;
+    bool frame_open_ = false;
+};
+#endif
+
+enum class Compression { None, Gzip, Zstd };
+
+static Compression detect_compression(FILE* file) {
+    array<unsigned char, 4> magic{};
+    size_t n = fread(magic.data(), 1, magic.size(), file);
+    rewind(file);
+
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return Compression::Gzip;
+    }
+    if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+        magic[2] == 0x2f && magic[3] == 0xfd) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+static unique_ptr<Decoder> make_decoder(FILE* file) {
+    auto compression = detect_compression(file);
+
+    if (compression == Compression::Gzip) {
+        return make_unique<GzipDecoder>(file);
+    }
+    if (compression == Compression::Zstd) {
+#ifdef GSEA_HAVE_ZSTD
+        return make_unique<ZstdDecoder>(file);
+#else
+        throw runtime_error("Input is zstd-compressed but zstd support was not built");
+#endif
+    }
+    return make_unique<PlainDecoder>(file);
+}
+
+bool is_compressed_file(const string& filepath) {
+    FILE* file = fopen(filepath.c_str(), "rb");
+    if (!file) return false;
+
+    bool compressed = detect_compression(file) != Compression::None;
+    fclose(file);
+    return compressed;
+}
+
+struct InputStream::Impl {
+    struct Slot {
+        vector<char> data = vector<char>(kSlotBytes);
+        size_t size = 0;
+    };
+
+    FILE* file = nullptr;
+    unique_ptr<Decoder> decoder;
+
+    // Ring of decode buffers: the producer fills slots in order starting at
+    // head + filled, the consumer drains them from head.
+    array<Slot, kRingSlots> ring;
+    size_t head = 0;
+    size_t filled = 0;
+    bool finished = false;
+    bool cancelled = false;
+    exception_ptr error;
+    mutex lock;
+    condition_variable slot_filled;
+    condition_variable slot_freed;
+    thread producer;
+
+    // Consumer cursor into ring[head]; only touched by the reading thread
+    bool holding = false;
+    size_t cursor = 0;
+
+    ~Impl() {
+        if (file) fclose(file);
+    }
+
+    void produce() {
+        try {
+            for (;;) {
+                size_t index;
+                {
+                    unique_lock guard(lock);
+                    slot_freed.wait(guard, [&] { return cancelled || filled < kRingSlots; });
+                    if (cancelled) return;
+                    index = (head + filled) % kRingSlots;
+                }
+
+                Slot& slot = ring[index];
+                slot.size = decoder->read(slot.data.data(), slot.data.size());
+
+                lock_guard guard(lock);
+                if (slot.size == 0) {
+                    finished = true;
+                    slot_filled.notify_one();
+                    return;
+                }
+                ++filled;
+                slot_filled.notify_one();
+            }
+        } catch (...) {
+            lock_guard guard(lock);
+            error = current_exception();
+            finished = true;
+            slot_filled.notify_one();
+        }
+    }
+
+    // Makes ring[head] available to the consumer; false once input is drained.
+    bool acquire() {
+        if (holding) return true;
+
+        unique_lock guard(lock);
+        slot_filled.wait(guard, [&] { return filled > 0 || finished; });
+        if (filled == 0) {
+            if (error) rethrow_exception(error);
+            return false;
+        }
+        holding = true;
+        cursor = 0;
+        return true;
+    }
+
+    void release() {
+        lock_guard guard(lock);
+        holding = false;
+        head = (head + 1) % kRingSlots;
+        --filled;
+        slot_freed.notify_one();
+    }
+};
+
+InputStream::InputStream(const string& filepath) : impl_(make_unique<Impl>()) {
+    impl_->file = fopen(filepath.c_str(), "rb");
+    if (!impl_->file) {
+        return;
+    }
+
+    impl_->decoder = make_decoder(impl_->file);
+    impl_->producer = thread([impl = impl_.get()] { impl->produce(); });
+}
+
+InputStream::~InputStream() {
+    if (impl_->producer.joinable()) {
+        {
+            lock_guard guard(impl_->lock);
+            impl_->cancelled = true;
+        }
+        impl_->slot_freed.notify_one();
+        impl_->producer.join();
+    }
+}
+
+bool InputStream::is_open() const noexcept {
+    return impl_->file != nullptr;
+}
+
+bool InputStream::read_line(string& line) {
+    line.clear();
+    if (!is_open()) return false;
+
+    bool extracted = false;
+    while (impl_->acquire()) {
+        auto& slot = impl_->ring[impl_->head];
+        const char* begin = slot.data.data() + impl_->cursor;
+        size_t remaining = slot.size - impl_->cursor;
+
+        const auto* newline = static_cast<const char*>(memchr(begin, '\n', remaining));
+        size_t length = newline ? static_cast<size_t>(newline - begin) : remaining;
+        line.append(begin, length);
+        extracted = true;
+
+        impl_->cursor += length + (newline ? 1 : 0);
+        if (impl_->cursor == slot.size) {
+            impl_->release();
+        }
+        if (newline) return true;
+    }
+
+    return extracted;
+}
+
+} // namespace gsea
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "data_loader/sample_loader.h"
-#include <fstream>
+#include "data_loader/input_stream.h"
+#include <cmath>
 #include <stdexcept>
 #include <string_view>
 #include <format>
@@ -32,7 +33,7 @@ static string trim(string_view str) {
 }
 
 SampleData load_sample_data(const string& filepath) {
-    ifstream file(filepath);
+    InputStream file(filepath);
     if (!file) {
         throw runtime_error(format("Failed to open sample file: {}", filepath));
     }
@@ -78,4 +79,55 @@ SampleData load_sample_data(const string& filepath) {
     return SampleData(std::move(sample_names), std::move(disease_status));
 }
 
+ContinuousPhenotype load_continuous_phenotype(const string& filepath) {
+    InputStream file(filepath);
+    if (!file) {
+        throw runtime_error(format("Failed to open phenotype file: {}", filepath));
+    }
+
+    ContinuousPhenotype phenotype;
+
+    string line;
+    size_t line_num = 0;
+
+    while (getline(file, line)) {
+        ++line_num;
+        if (line.empty()) continue;
+
+        auto tokens = split(line, '\t');
+        if (tokens.size() != 2) {
+            throw runtime_error(
+                format("Invalid format at line {}: expected 2 columns, found {}",
+                    line_num, tokens.size()));
+        }
+
+        auto text = trim(tokens[1]);
+        double value = 0.0;
+        try {
+            size_t parsed = 0;
+            value = stod(text, &parsed);
+            if (parsed != text.size()) {
+                throw invalid_argument(text);
+            }
+        } catch (const logic_error&) {
+            throw runtime_error(
+                format("Invalid phenotype value at line {}: '{}' is not a valid number",
+                    line_num, tokens[1]));
+        }
+        if (!isfinite(value)) {
+            throw runtime_error(
+                format("Invalid phenotype value at line {}: must be finite", line_num));
+        }
+
+        phenotype.sample_names.push_back(trim(tokens[0]));
+        phenotype.values.push_back(value);
+    }
+
+    if (phenotype.sample_names.empty()) {
+        throw runtime_error("Phenotype file contains no data");
+    }
+
+    return phenotype;
+}
+
 } // namespace gsea
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "data_loader/score_matrix_writer.h"
+#include <array>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr array<char, 8> kMatrixMagic = {'G', 'S', 'E', 'A', 'M', 'A', 'T', '1'};
+
+static void check_shape(const ScoreMatrix& scores,
+                        span<const string> row_names,
+                        span<const string> column_names) {
+    if (static_cast<size_t>(scores.rows()) != row_names.size() ||
+        static_cast<size_t>(scores.cols()) != column_names.size()) {
+        throw invalid_argument("Score matrix shape must match row and column name counts");
+    }
+}
+
+template <typename T>
+static void write_pod(ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write_score_matrix_tsv(const string& filepath,
+                            const ScoreMatrix& scores,
+                            span<const string> row_names,
+                            span<const string> column_names,
+                            string_view row_header) {
+    check_shape(scores, row_names, column_names);
+
+    ofstream file(filepath);
+    if (!file) {
+        throw runtime_error(format("Failed to create output file: {}", filepath));
+    }
+
+    file << row_header;
+    for (const auto& name : column_names) {
+        file << '\t' << name;
+    }
+    file << '\n';
+
+    for (Eigen::Index row = 0; row < scores.rows(); ++row) {
+        file << row_names[row];
+        for (Eigen::Index col = 0; col < scores.cols(); ++col) {
+            file << format("\t{}", scores(row, col));
+        }
+        file << '\n';
+    }
+}
+
+void write_score_matrix_binary(const string& filepath,
+                               const ScoreMatrix& scores,
+                               span<const string> row_names,
+                               span<const string> column_names) {
+    check_shape(scores, row_names, column_names);
+
+    ofstream file(filepath, ios::binary);
+    if (!file) {
+        throw runtime_error(format("Failed to create output file: {}", filepath));
+    }
+
+    file.write(kMatrixMagic.data(), kMatrixMagic.size());
+    write_pod(file, static_cast<uint64_t>(scores.rows()));
+    write_pod(file, static_cast<uint64_t>(scores.cols()));
+    file.write(reinterpret_cast<const char*>(scores.data()),
+               static_cast<streamsize>(scores.size() * sizeof(double)));
+
+    for (auto names : {row_names, column_names}) {
+        for (const auto& name : names) {
+            write_pod(file, static_cast<uint32_t>(name.size()));
+            file.write(name.data(), static_cast<streamsize>(name.size()));
+        }
+    }
+
+    if (!file) {
+        throw runtime_error(format("Failed to write output file: {}", filepath));
+    }
+}
+
+} // namespace gsea
\ No newline at end of file
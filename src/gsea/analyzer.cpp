@@ -5,25 +5,53 @@
 #include "gsea/ranking.h"
 #include "gsea/enrichment.h"
 #include "gsea/statistics.h"
+#include "gsea/numa.h"
+#include "gsea/permutation_store.h"
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 #include <format>
+#include <future>
+#include <thread>
 
 using namespace std;
 
 namespace gsea {
 
+struct GSEAAnalyzer::LoadedInputs {
+    ExpressionData expression;
+    SampleData samples;
+    vector<GeneSetRecord> gene_set_records;
+    GeneSetFilter filter;
+};
+
+GSEAAnalyzer::LoadedInputs GSEAAnalyzer::load_inputs(const string& exp_file,
+                                                     const string& samp_file,
+                                                     const string& geneset_file,
+                                                     const GeneSetFilter& filter) {
+    cout << "  Loading inputs...\n";
+    auto expression = async(launch::async, [&] { return load_expression_data(exp_file); });
+    auto samples = async(launch::async, load_sample_data, samp_file);
+    auto records = async(launch::async, read_gene_set_records, geneset_file, filter);
+
+    return {expression.get(), samples.get(), records.get(), filter};
+}
+
 GSEAAnalyzer::GSEAAnalyzer(const string& exp_file,
                            const string& samp_file,
-                           const string& geneset_file)
-    : expression_(load_expression_data(exp_file)),
-      samples_(load_sample_data(samp_file))
+                           const string& geneset_file,
+                           const GeneSetFilter& filter)
+    : GSEAAnalyzer(load_inputs(exp_file, samp_file, geneset_file, filter))
+{
+}
+
+GSEAAnalyzer::GSEAAnalyzer(LoadedInputs&& inputs)
+    : expression_(std::move(inputs.expression)),
+      samples_(std::move(inputs.samples))
 {
-    cout << "  Loading expression data...\n";
     cout << format("    Loaded {} genes across {} samples\n",
               expression_.num_genes(), expression_.num_samples());
 
-    cout << "  Loading sample data...\n";
     cout << format("    Loaded {} samples ({} diseased, {} healthy)\n",
               samples_.num_samples(), samples_.num_diseased(), samples_.num_healthy());
 
@@ -32,11 +60,99 @@ GSEAAnalyzer::GSEAAnalyzer(const string& exp_file,
         sample_to_column_[string(expression_.sample_names()[i])] = i;
     }
 
-    cout << "  Loading gene sets...\n";
-    vector<string> gene_names_vec(expression_.gene_names().begin(),
-                                             expression_.gene_names().end());
-    gene_sets_ = load_gene_sets(geneset_file, gene_names_vec);
+    gene_sets_ = resolve_gene_sets(inputs.gene_set_records, expression_.gene_names(),
+                                   inputs.filter);
     cout << format("    Loaded {} gene sets\n", gene_sets_.size());
+
+    index_unique_sets();
+    if (representatives_.size() < gene_sets_.size()) {
+        cout << format("    {} gene sets are identical to another set and share its scores\n",
+                  gene_sets_.size() - representatives_.size());
+    }
+}
+
+GSEAAnalyzer::GSEAAnalyzer(MatrixView values,
+                           span<const string> gene_names,
+                           span<const string> sample_names,
+                           span<const uint8_t> disease_status,
+                           vector<GeneSet> gene_sets)
+    : expression_(values, gene_names, sample_names),
+      samples_(sample_names, disease_status),
+      gene_sets_(std::move(gene_sets))
+{
+    if (gene_sets_.empty()) {
+        throw invalid_argument("At least one gene set is required");
+    }
+
+    for (const auto& gene_set : gene_sets_) {
+        if (gene_set.num_genes() != expression_.num_genes()) {
+            throw invalid_argument(format(
+                "Gene set '{}' was resolved against {} genes, expression has {}",
+                gene_set.get_name(), gene_set.num_genes(), expression_.num_genes()));
+        }
+    }
+
+    for (size_t i = 0; i < expression_.sample_names().size(); ++i) {
+        sample_to_column_[string(expression_.sample_names()[i])] = i;
+    }
+
+    index_unique_sets();
+}
+
+void GSEAAnalyzer::index_unique_sets() {
+    auto representative = find_identical_sets(gene_sets_);
+
+    representatives_.clear();
+    unique_index_.assign(gene_sets_.size(), 0);
+    for (size_t i = 0; i < gene_sets_.size(); ++i) {
+        if (representative[i] == i) {
+            unique_index_[i] = representatives_.size();
+            representatives_.push_back(i);
+        } else {
+            unique_index_[i] = unique_index_[representative[i]];
+        }
+    }
+}
+
+vector<GeneSet> GSEAAnalyzer::unique_sets() const {
+    // Views into gene_sets_, valid until it next changes
+    vector<GeneSet> sets;
+    sets.reserve(representatives_.size());
+    for (size_t i : representatives_) {
+        sets.emplace_back(string(gene_sets_[i].get_name()),
+                          gene_sets_[i].members(),
+                          gene_sets_[i].num_genes());
+    }
+    return sets;
+}
+
+vector<double> GSEAAnalyzer::score_unique_sets(span<const GeneSet> unique_sets) {
+    if (gene_rank_.empty()) {
+        get_gene_rank_order();
+    }
+
+    vector<double> scores(unique_sets.size());
+    score_gene_sets(unique_sets, gene_rank_, scores);
+    return scores;
+}
+
+size_t GSEAAnalyzer::collapse_redundant_sets(double threshold, OverlapMetric metric) {
+    auto kept = select_nonredundant_sets(gene_sets_, threshold, metric);
+    size_t removed = gene_sets_.size() - kept.size();
+
+    vector<GeneSet> kept_sets;
+    kept_sets.reserve(kept.size());
+    for (size_t idx : kept) {
+        kept_sets.push_back(std::move(gene_sets_[idx]));
+    }
+    gene_sets_ = std::move(kept_sets);
+
+    index_unique_sets();
+    return removed;
+}
+
+void GSEAAnalyzer::set_permutation_store(string directory, uint64_t seed) {
+    permutation_store_ = PermutationStoreConfig{std::move(directory), seed};
 }
 
 vector<string> GSEAAnalyzer::get_gene_rank_order() {
@@ -59,7 +175,7 @@ vector<string> GSEAAnalyzer::get_gene_rank_order() {
             "No matching samples found between sample and expression files");
     }
 
-    gene_rank_ = compute_gene_rank(expression_, disease_cols, healthy_cols);
+    gene_rank_ = compute_gene_rank(expression_, disease_cols, healthy_cols, true);
 
     vector<string> gene_names;
     gene_names.reserve(gene_rank_.size());
@@ -83,56 +199,187 @@ double GSEAAnalyzer::get_enrichment_score(const GeneSet& gene_set,
 }
 
 unordered_map<string, double> GSEAAnalyzer::compute_all_enrichment_scores() {
-    if (gene_rank_.empty()) {
-        get_gene_rank_order();
-    }
+    auto set_scores = score_unique_sets(unique_sets());
 
     unordered_map<string, double> scores;
-    for (const auto& gene_set : gene_sets_) {
-        scores[string(gene_set.get_name())] = calculate_enrichment_score(gene_set, gene_rank_);
+    for (size_t i = 0; i < gene_sets_.size(); ++i) {
+        scores[string(gene_sets_[i].get_name())] = set_scores[unique_index_[i]];
     }
 
     return scores;
 }
 
-vector<string> GSEAAnalyzer::get_significant_sets(double p_value,
-                                                             size_t sample_size) {
-    if (gene_rank_.empty()) {
-        get_gene_rank_order();
+void GSEAAnalyzer::compute_unique_null(span<const GeneSet> unique_sets,
+                                       size_t sample_size,
+                                       span<double> null_distribution) {
+    if (numa_) {
+        compute_null_distribution_numa(
+            expression_,
+            unique_sets,
+            samples_.num_diseased(),
+            sample_size,
+            null_distribution
+        );
+    } else {
+        compute_null_distribution(
+            expression_,
+            unique_sets,
+            samples_.num_diseased(),
+            sample_size,
+            null_distribution
+        );
     }
+}
 
+vector<PValueEstimate> GSEAAnalyzer::get_p_values(size_t sample_size,
+                                                  bool tail_approximation) {
     // Compute actual enrichment scores
-    vector<double> actual_scores;
-    actual_scores.reserve(gene_sets_.size());
-    for (const auto& gene_set : gene_sets_) {
-        actual_scores.push_back(calculate_enrichment_score(gene_set, gene_rank_));
-    }
+    auto unique = unique_sets();
+    auto actual_scores = score_unique_sets(unique);
 
     cout << format("  Generating null distribution with {} permutations...\n", sample_size);
 
     // Compute null distribution
-    auto null_distribution = compute_null_distribution(
-        expression_,
-        gene_sets_,
-        samples_.num_diseased(),
-        sample_size
-    );
+    vector<double> null_distribution(sample_size * unique.size());
+    if (permutation_store_) {
+        auto store = PermutationStore::open(
+            permutation_store_->directory,
+            expression_,
+            samples_.num_diseased(),
+            permutation_store_->seed,
+            sample_size
+        );
+        cout << format("    Permutation store holds {} rankings\n", store.num_permutations());
+        store.score(unique, sample_size, null_distribution);
+    } else {
+        compute_unique_null(unique, sample_size, null_distribution);
+    }
 
-    // Find significant sets
-    auto significant_indices = find_significant_sets(
+    auto unique_estimates = estimate_p_values(
         actual_scores,
         null_distribution,
-        p_value,
-        gene_sets_.size()
+        unique.size(),
+        tail_approximation
     );
 
+    vector<PValueEstimate> estimates;
+    estimates.reserve(gene_sets_.size());
+    for (size_t i = 0; i < gene_sets_.size(); ++i) {
+        estimates.push_back(unique_estimates[unique_index_[i]]);
+    }
+
+    return estimates;
+}
+
+vector<string> GSEAAnalyzer::get_significant_sets(double p_value,
+                                                  size_t sample_size,
+                                                  bool tail_approximation) {
+    auto estimates = get_p_values(sample_size, tail_approximation);
+    double corrected_p = p_value / gene_sets_.size();
+
     vector<string> significant_names;
-    significant_names.reserve(significant_indices.size());
-    for (size_t idx : significant_indices) {
-        significant_names.emplace_back(gene_sets_[idx].get_name());
+    for (size_t i = 0; i < estimates.size(); ++i) {
+        if (estimates[i].p_value < corrected_p) {
+            significant_names.emplace_back(gene_sets_[i].get_name());
+        }
     }
 
     return significant_names;
 }
 
+size_t plan_anytime_batch(size_t batch_size,
+                          size_t probe_size,
+                          size_t permutations,
+                          chrono::duration<double> spent,
+                          chrono::duration<double> remaining) {
+    if (permutations == 0) {
+        return min(batch_size, probe_size);
+    }
+    if (remaining.count() <= 0.0) {
+        return 0;
+    }
+    double per_permutation = spent.count() / permutations;
+    if (per_permutation <= 0.0) {
+        return batch_size;
+    }
+    double affordable = floor(remaining.count() / per_permutation);
+    // The quotient may round up past an exact fit
+    if (affordable > 0.0 && affordable * per_permutation > remaining.count()) {
+        affordable -= 1.0;
+    }
+    return affordable < batch_size ? static_cast<size_t>(affordable) : batch_size;
+}
+
+SignificanceProgress GSEAAnalyzer::get_significant_sets_anytime(
+    double p_value,
+    chrono::steady_clock::duration time_budget,
+    const SignificanceCallback& on_progress,
+    size_t batch_size,
+    double confidence,
+    size_t max_permutations) {
+
+    if (batch_size == 0) {
+        throw invalid_argument("Permutation batch size must be positive");
+    }
+
+    auto start = chrono::steady_clock::now();
+    auto unique = unique_sets();
+    auto actual_scores = score_unique_sets(unique);
+    size_t num_unique = unique.size();
+    size_t num_sets = gene_sets_.size();
+
+    SignificanceProgress progress{0, {}, p_value / num_sets, {}, {}, {}, {}, 0};
+    progress.estimates.resize(num_sets);
+    progress.intervals.resize(num_sets);
+    progress.significant.resize(num_sets);
+    progress.decided.resize(num_sets);
+
+    // Only exceedance counts are kept, so memory stays at one batch
+    vector<size_t> count_greater(num_unique, 0);
+    vector<double> null_distribution;
+
+    size_t probe_size = max<size_t>(1, thread::hardware_concurrency());
+    auto loop_start = chrono::steady_clock::now();
+
+    while (progress.permutations < max_permutations) {
+        auto now = chrono::steady_clock::now();
+        size_t batch = plan_anytime_batch(min(batch_size, max_permutations - progress.permutations),
+                                          probe_size, progress.permutations,
+                                          now - loop_start, time_budget - (now - start));
+        if (batch == 0) break;
+
+        null_distribution.resize(batch * num_unique);
+        compute_unique_null(unique, batch, null_distribution);
+
+        for (size_t sample = 0; sample < batch; ++sample) {
+            for (size_t i = 0; i < num_unique; ++i) {
+                if (null_distribution[sample * num_unique + i] >= actual_scores[i]) {
+                    ++count_greater[i];
+                }
+            }
+        }
+        progress.permutations += batch;
+        progress.elapsed = chrono::steady_clock::now() - start;
+
+        progress.num_decided = 0;
+        for (size_t i = 0; i < num_sets; ++i) {
+            size_t count = count_greater[unique_index_[i]];
+            double p = static_cast<double>(count) / progress.permutations;
+            auto interval = wilson_interval(count, progress.permutations, confidence);
+
+            progress.estimates[i] = {p, count, nullopt};
+            progress.intervals[i] = interval;
+            progress.significant[i] = p < progress.corrected_p;
+            progress.decided[i] = interval.upper < progress.corrected_p ||
+                                  interval.lower >= progress.corrected_p;
+            progress.num_decided += progress.decided[i];
+        }
+
+        if (on_progress && !on_progress(progress)) break;
+        if (progress.num_decided == num_sets || progress.elapsed >= time_budget) break;
+    }
+
+    return progress;
+}
+
 } // namespace gsea
\ No newline at end of file
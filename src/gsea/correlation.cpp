@@ -0,0 +1,207 @@
+#include "gsea/correlation.h"
+#include "gsea/radix_sort.h"
+#include "gsea/gene_set_index.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#ifdef USE_PARALLEL_STL
+#include <execution>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+// 1-based ranks with ties given their average rank
+static void average_ranks(span<double> values, vector<uint32_t>& order) {
+    size_t n = values.size();
+    order.resize(n);
+    iota(order.begin(), order.end(), uint32_t{0});
+    ranges::stable_sort(order, {}, [&](uint32_t i) { return values[i]; });
+
+    vector<double> ranks(n);
+    for (size_t start = 0; start < n;) {
+        size_t end = start + 1;
+        while (end < n && values[order[end]] == values[order[start]]) ++end;
+        double rank = (start + end + 1) / 2.0;
+        for (size_t k = start; k < end; ++k) {
+            ranks[order[k]] = rank;
+        }
+        start = end;
+    }
+    ranges::copy(ranks, values.begin());
+}
+
+// Centres values and scales them to unit norm; false if they are constant
+template <typename Vector>
+static bool standardize(Vector&& values) {
+    values.array() -= values.mean();
+    double norm = values.norm();
+    if (norm <= 0.0) {
+        values.setZero();
+        return false;
+    }
+    values /= norm;
+    return true;
+}
+
+// Gene positions from correlations, via a descending sort
+static void correlation_positions(span<const double> correlations,
+                                  span<uint32_t> order,
+                                  span<uint32_t> gene_position,
+                                  bool parallel) {
+    radix_sort_descending(correlations, order, parallel);
+    for (size_t i = 0; i < order.size(); ++i) {
+        gene_position[order[i]] = static_cast<uint32_t>(i);
+    }
+}
+
+CorrelationModel make_correlation_model(const ExpressionData& expression,
+                                        const ContinuousPhenotype& phenotype,
+                                        CorrelationMethod method) {
+    unordered_map<string_view, size_t> column;
+    for (size_t i = 0; i < expression.num_samples(); ++i) {
+        column.emplace(expression.sample_names()[i], i);
+    }
+
+    vector<size_t> columns;
+    vector<double> covariate;
+    for (size_t i = 0; i < phenotype.sample_names.size(); ++i) {
+        if (auto it = column.find(phenotype.sample_names[i]); it != column.end()) {
+            columns.push_back(it->second);
+            covariate.push_back(phenotype.values[i]);
+        }
+    }
+    if (columns.size() < 3) {
+        throw runtime_error(format(
+            "Correlation needs at least 3 samples in both files, found {}", columns.size()));
+    }
+
+    size_t num_genes = expression.num_genes();
+    size_t num_samples = columns.size();
+    auto values = expression.values();
+
+    CorrelationModel model;
+    model.standardized.resize(num_genes, num_samples);
+    for (size_t j = 0; j < num_samples; ++j) {
+        model.standardized.col(j) = values.col(columns[j]);
+    }
+
+    vector<uint32_t> order;
+    if (method == CorrelationMethod::Spearman) {
+        average_ranks(covariate, order);
+    }
+    model.phenotype = Eigen::Map<const Eigen::VectorXd>(covariate.data(), num_samples);
+    if (!standardize(model.phenotype)) {
+        throw runtime_error("Phenotype is constant across the matched samples");
+    }
+
+    // Rows are strided in column-major storage; standardise a copy of each
+    vector<size_t> genes(num_genes);
+    iota(genes.begin(), genes.end(), size_t{0});
+    auto standardize_gene = [&](size_t g) {
+        Eigen::VectorXd row = model.standardized.row(g).transpose();
+        if (method == CorrelationMethod::Spearman) {
+            vector<uint32_t> row_order;
+            average_ranks(span{row.data(), num_samples}, row_order);
+        }
+        standardize(row);
+        model.standardized.row(g) = row.transpose();
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, genes.begin(), genes.end(), standardize_gene);
+#else
+    for_each(genes.begin(), genes.end(), standardize_gene);
+#endif
+
+    return model;
+}
+
+Eigen::VectorXd compute_gene_correlations(const CorrelationModel& model) {
+    return model.standardized * model.phenotype;
+}
+
+vector<size_t> compute_correlation_rank(const CorrelationModel& model, bool parallel) {
+    Eigen::VectorXd correlations = compute_gene_correlations(model);
+    vector<uint32_t> order(correlations.size());
+    radix_sort_descending(span{correlations.data(), order.size()}, order, parallel);
+    return {order.begin(), order.end()};
+}
+
+void compute_correlation_null_distribution(const CorrelationModel& model,
+                                           span<const GeneSet> gene_sets,
+                                           size_t sample_size,
+                                           span<double> null_distribution,
+                                           size_t block_size) {
+    size_t num_sets = gene_sets.size();
+    if (null_distribution.size() != sample_size * num_sets) {
+        throw invalid_argument("Null distribution buffer must hold sample_size * num_sets scores");
+    }
+    if (block_size == 0) {
+        throw invalid_argument("Permutation block size must be positive");
+    }
+    if (num_sets == 0) return;
+
+    size_t num_genes = static_cast<size_t>(model.standardized.rows());
+    size_t num_samples = static_cast<size_t>(model.standardized.cols());
+    // Smaller blocks when there are too few permutations to fill every thread
+    size_t threads = max<size_t>(1, thread::hardware_concurrency());
+    block_size = min(block_size, max<size_t>(16, (sample_size + threads - 1) / threads));
+    size_t num_blocks = (sample_size + block_size - 1) / block_size;
+    uint64_t seed = random_device{}();
+
+    // Checked before the parallel loop, which cannot propagate exceptions
+    GeneSetIndex index(gene_sets);
+    if (index.num_genes() != num_genes) {
+        throw invalid_argument(format("Gene sets were resolved against {} genes, expression has {}",
+                                      index.num_genes(), num_genes));
+    }
+
+    vector<size_t> blocks(num_blocks);
+    iota(blocks.begin(), blocks.end(), size_t{0});
+
+    auto run_block = [&](size_t block) {
+        size_t first = block * block_size;
+        size_t count = min(block_size, sample_size - first);
+
+        seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                          static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32)};
+        mt19937_64 gen(sequence);
+
+        // A shuffled standardised vector is still standardised
+        Eigen::MatrixXd permuted(num_samples, count);
+        vector<uint32_t> shuffle(num_samples);
+        iota(shuffle.begin(), shuffle.end(), uint32_t{0});
+        for (size_t j = 0; j < count; ++j) {
+            ranges::shuffle(shuffle, gen);
+            for (size_t i = 0; i < num_samples; ++i) {
+                permuted(i, j) = model.phenotype(shuffle[i]);
+            }
+        }
+
+        Eigen::MatrixXd correlations = model.standardized * permuted;
+
+        vector<uint32_t> order(num_genes);
+        vector<uint32_t> gene_position(num_genes);
+        for (size_t j = 0; j < count; ++j) {
+            correlation_positions(span{correlations.col(j).data(), num_genes},
+                                  order, gene_position, false);
+            index.score(gene_position, null_distribution.subspan((first + j) * num_sets, num_sets));
+        }
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, blocks.begin(), blocks.end(), run_block);
+#else
+    for_each(blocks.begin(), blocks.end(), run_block);
+#endif
+}
+
+} // namespace gsea
\ No newline at end of file
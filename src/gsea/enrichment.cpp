@@ -1,6 +1,10 @@
 #include "gsea/enrichment.h"
+#include "gsea/ranking.h"
 #include <ranges>
 #include <algorithm>
+#include <vector>
+#include <limits>
+#include <stdexcept>
 
 using namespace std;
 
@@ -11,9 +15,14 @@ Eigen::VectorXd compute_brownian_bridge(const GeneSet& gene_set,
     size_t num_genes = gene_rank.size();
     Eigen::VectorXd bridge(num_genes);
 
+    vector<uint8_t> in_set(num_genes, 0);
+    for (uint32_t idx : gene_set.members()) {
+        in_set[idx] = 1;
+    }
+
     double cumsum = 0.0;
     for (size_t i = 0; i < num_genes; ++i) {
-        cumsum += gene_set.scores()(gene_rank[i]);
+        cumsum += in_set[gene_rank[i]] ? gene_set.up_score() : gene_set.down_score();
         bridge(i) = cumsum;
     }
 
@@ -22,9 +31,59 @@ Eigen::VectorXd compute_brownian_bridge(const GeneSet& gene_set,
 
 double calculate_enrichment_score(const GeneSet& gene_set,
                                    span<const size_t> gene_rank) {
-    auto bridge = compute_brownian_bridge(gene_set, gene_rank);
+    vector<uint32_t> gene_position(gene_rank.size());
+    invert_gene_rank(gene_rank, gene_position);
 
-    return ranges::max(bridge);
+    return calculate_enrichment_score_at(gene_set, gene_position);
+}
+
+double enrichment_score_from_hits(span<uint32_t> hits,
+                                  double up_score,
+                                  double down_score) {
+    ranges::sort(hits);
+    return enrichment_score_from_sorted_hits(hits, up_score, down_score);
+}
+
+double enrichment_score_from_sorted_hits(span<const uint32_t> hits,
+                                         double up_score,
+                                         double down_score) {
+    // The running sum only rises at hits, so its maximum is reached right
+    // after one: j hits and (position + 1 - j) misses so far.
+    double best = -numeric_limits<double>::infinity();
+    for (size_t j = 0; j < hits.size(); ++j) {
+        size_t misses = hits[j] - j;
+        double sum = static_cast<double>(j + 1) * up_score;
+        if (misses > 0) {
+            sum += static_cast<double>(misses) * down_score;
+        }
+        best = max(best, sum);
+    }
+
+    return best;
+}
+
+double calculate_enrichment_score_at(const GeneSet& gene_set,
+                                      span<const uint32_t> gene_position) {
+    auto members = gene_set.members();
+    vector<uint32_t> hits(members.size());
+    ranges::transform(members, hits.begin(), [&](uint32_t idx) { return gene_position[idx]; });
+
+    return enrichment_score_from_hits(hits, gene_set.up_score(), gene_set.down_score());
+}
+
+void score_gene_sets(span<const GeneSet> gene_sets,
+                     span<const size_t> gene_rank,
+                     span<double> scores) {
+    if (scores.size() != gene_sets.size()) {
+        throw invalid_argument("Score buffer size must match the number of gene sets");
+    }
+
+    vector<uint32_t> gene_position(gene_rank.size());
+    invert_gene_rank(gene_rank, gene_position);
+
+    for (size_t i = 0; i < gene_sets.size(); ++i) {
+        scores[i] = calculate_enrichment_score_at(gene_sets[i], gene_position);
+    }
 }
 
 } // namespace gsea
\ No newline at end of file
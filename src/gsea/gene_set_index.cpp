@@ -0,0 +1,150 @@
+#include "gsea/gene_set_index.h"
+#include "gsea/ranking.h"
+#include "gsea/enrichment.h"
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <numeric>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gsea {
+
+GeneSetIndex::GeneSetIndex(span<const GeneSet> gene_sets) {
+    size_t num_sets = gene_sets.size();
+    num_genes_ = num_sets > 0 ? gene_sets[0].num_genes() : 0;
+
+    set_order_.resize(num_sets);
+    iota(set_order_.begin(), set_order_.end(), uint32_t{0});
+    ranges::stable_sort(set_order_, {}, [&](uint32_t s) { return gene_sets[s].size(); });
+
+    size_t total_members = 0;
+    for (const auto& gene_set : gene_sets) {
+        if (gene_set.num_genes() != num_genes_) {
+            throw invalid_argument(format(
+                "Gene set '{}' was resolved against {} genes, expected {}",
+                gene_set.get_name(), gene_set.num_genes(), num_genes_));
+        }
+        total_members += gene_set.size();
+    }
+
+    offsets_.reserve(num_sets + 1);
+    members_.reserve(total_members);
+    up_scores_.reserve(num_sets);
+    down_scores_.reserve(num_sets);
+
+    // Members are sorted here, as borrowed sets need not be, so gathers read
+    // gene positions in address order
+    offsets_.push_back(0);
+    for (uint32_t s : set_order_) {
+        const auto& gene_set = gene_sets[s];
+        size_t first = members_.size();
+        members_.insert(members_.end(), gene_set.members().begin(), gene_set.members().end());
+        sort(members_.begin() + static_cast<ptrdiff_t>(first), members_.end());
+        offsets_.push_back(static_cast<uint32_t>(members_.size()));
+        up_scores_.push_back(gene_set.up_score());
+        down_scores_.push_back(gene_set.down_score());
+        max_set_size_ = max(max_set_size_, gene_set.size());
+    }
+
+    // Walking the ranking costs O(genes + members), gathering and sorting
+    // O(members * log set size)
+    size_t mean_size = num_sets > 0 ? total_members / num_sets : 0;
+    scan_ranking_ = total_members * bit_width(max<size_t>(mean_size, 2)) >= num_genes_;
+    if (!scan_ranking_) return;
+
+    gene_offsets_.assign(num_genes_ + 1, 0);
+    for (uint32_t gene : members_) {
+        ++gene_offsets_[gene + 1];
+    }
+    partial_sum(gene_offsets_.begin(), gene_offsets_.end(), gene_offsets_.begin());
+    gene_sets_.resize(members_.size());
+    vector<uint32_t> fill(gene_offsets_.begin(), gene_offsets_.end() - 1);
+    for (uint32_t i = 0; i < num_sets; ++i) {
+        for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+            gene_sets_[fill[members_[k]]++] = i;
+        }
+    }
+}
+
+template <typename Index>
+void GeneSetIndex::score_by_rank(span<const Index> gene_rank, span<double> scores) const {
+    thread_local vector<uint32_t> hits;
+    thread_local vector<uint32_t> next;
+    hits.resize(members_.size());
+    next.assign(offsets_.begin(), offsets_.end() - 1);
+
+    for (size_t position = 0; position < gene_rank.size(); ++position) {
+        auto gene = gene_rank[position];
+        for (size_t k = gene_offsets_[gene]; k < gene_offsets_[gene + 1]; ++k) {
+            hits[next[gene_sets_[k]]++] = static_cast<uint32_t>(position);
+        }
+    }
+
+    for (size_t i = 0; i < set_order_.size(); ++i) {
+        span<const uint32_t> set_hits(hits.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+        scores[set_order_[i]] =
+            enrichment_score_from_sorted_hits(set_hits, up_scores_[i], down_scores_[i]);
+    }
+}
+
+void GeneSetIndex::score_by_gather(span<const uint32_t> gene_position,
+                                   span<double> scores) const {
+    thread_local vector<uint32_t> hits;
+    hits.resize(max_set_size_);
+    for (size_t i = 0; i < set_order_.size(); ++i) {
+        size_t first = offsets_[i];
+        size_t size = offsets_[i + 1] - first;
+        for (size_t k = 0; k < size; ++k) {
+            hits[k] = gene_position[members_[first + k]];
+        }
+        scores[set_order_[i]] = enrichment_score_from_hits(
+            span{hits.data(), size}, up_scores_[i], down_scores_[i]);
+    }
+}
+
+void GeneSetIndex::score(span<const uint32_t> gene_position, span<double> scores) const {
+    if (scores.size() != num_sets()) {
+        throw invalid_argument("Score buffer size must match the number of gene sets");
+    }
+    // An empty index was built without knowing the genes; there is nothing to score
+    if (num_sets() == 0) return;
+    if (gene_position.size() != num_genes_) {
+        throw invalid_argument("Position buffer size must match the number of genes");
+    }
+
+    if (!scan_ranking_) {
+        score_by_gather(gene_position, scores);
+        return;
+    }
+
+    thread_local vector<uint32_t> gene_rank;
+    gene_rank.resize(num_genes_);
+    for (size_t gene = 0; gene < num_genes_; ++gene) {
+        gene_rank[gene_position[gene]] = static_cast<uint32_t>(gene);
+    }
+    score_by_rank(span<const uint32_t>(gene_rank), scores);
+}
+
+void GeneSetIndex::score_ranking(span<const size_t> gene_rank, span<double> scores) const {
+    if (scores.size() != num_sets()) {
+        throw invalid_argument("Score buffer size must match the number of gene sets");
+    }
+    if (num_sets() == 0) return;
+    if (gene_rank.size() != num_genes_) {
+        throw invalid_argument("Gene rank size must match the number of genes");
+    }
+
+    if (scan_ranking_) {
+        score_by_rank(gene_rank, scores);
+        return;
+    }
+
+    thread_local vector<uint32_t> gene_position;
+    gene_position.resize(num_genes_);
+    invert_gene_rank(gene_rank, gene_position);
+    score_by_gather(gene_position, scores);
+}
+
+} // namespace gsea
\ No newline at end of file
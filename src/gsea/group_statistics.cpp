@@ -0,0 +1,242 @@
+#include "gsea/group_statistics.h"
+#include "gsea/radix_sort.h"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr array<char, 8> kStatisticsMagic = {'G', 'S', 'E', 'A', 'S', 'T', 'A', '2'};
+
+template <typename T>
+static void write_pod(ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool read_pod(istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+static void write_string(ostream& out, const string& str) {
+    write_pod(out, static_cast<uint32_t>(str.size()));
+    out.write(str.data(), static_cast<streamsize>(str.size()));
+}
+
+static bool read_string(istream& in, string& str) {
+    uint32_t length = 0;
+    if (!read_pod(in, length)) return false;
+    str.resize(length);
+    return static_cast<bool>(in.read(str.data(), length));
+}
+
+static void write_values(ostream& out, const vector<double>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<streamsize>(values.size() * sizeof(double)));
+}
+
+static bool read_values(istream& in, vector<double>& values, size_t count) {
+    values.resize(count);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()),
+                                     static_cast<streamsize>(count * sizeof(double))));
+}
+
+GroupStatistics make_group_statistics(span<const string> gene_names) {
+    size_t num_genes = gene_names.size();
+    GroupStatistics statistics;
+    statistics.gene_names.assign(gene_names.begin(), gene_names.end());
+    statistics.disease_sum.assign(num_genes, 0.0);
+    statistics.healthy_sum.assign(num_genes, 0.0);
+    statistics.disease_sum_sq.assign(num_genes, 0.0);
+    statistics.healthy_sum_sq.assign(num_genes, 0.0);
+    return statistics;
+}
+
+bool labels_unchanged(const GroupStatistics& statistics, const SampleData& samples) {
+    unordered_map<string_view, uint8_t> labels;
+    for (size_t i = 0; i < samples.num_samples(); ++i) {
+        labels.emplace(samples.sample_names()[i], samples.disease_status()[i]);
+    }
+
+    for (size_t i = 0; i < statistics.sample_names.size(); ++i) {
+        auto it = labels.find(statistics.sample_names[i]);
+        if (it == labels.end() || it->second != statistics.disease_status[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool columns_unchanged(const GroupStatistics& statistics,
+                       span<const optional<uint64_t>> fingerprints) {
+    if (fingerprints.size() != statistics.fingerprints.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+        if (fingerprints[i] != statistics.fingerprints[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t accumulate_samples(GroupStatistics& statistics,
+                          const ExpressionData& expression,
+                          const SampleData& samples,
+                          span<const uint64_t> column_fingerprints) {
+    if (column_fingerprints.size() != expression.num_samples()) {
+        throw invalid_argument("Need one fingerprint per expression column");
+    }
+    if (!ranges::equal(statistics.gene_names, expression.gene_names())) {
+        throw invalid_argument("Expression genes differ from the accumulated statistics");
+    }
+    if (!labels_unchanged(statistics, samples)) {
+        throw invalid_argument("Accumulated samples were removed or relabelled");
+    }
+
+    unordered_map<string_view, size_t> column;
+    for (size_t i = 0; i < expression.num_samples(); ++i) {
+        column.emplace(expression.sample_names()[i], i);
+    }
+    // Owned copies: appending to sample_names below may reallocate it
+    unordered_set<string> accumulated(statistics.sample_names.begin(),
+                                      statistics.sample_names.end());
+
+    auto values = expression.values();
+    size_t num_genes = statistics.num_genes();
+    size_t added = 0;
+
+    // Same order of additions as compute_gene_rank, so a full rebuild and an
+    // incremental update of appended samples agree exactly
+    for (size_t i = 0; i < samples.num_samples(); ++i) {
+        string_view name = samples.sample_names()[i];
+        auto it = column.find(name);
+        if (it == column.end() || accumulated.contains(string(name))) continue;
+
+        bool diseased = samples.disease_status()[i] == 1;
+        auto& sum = diseased ? statistics.disease_sum : statistics.healthy_sum;
+        auto& sum_sq = diseased ? statistics.disease_sum_sq : statistics.healthy_sum_sq;
+        const double* col = values.col(static_cast<Eigen::Index>(it->second)).data();
+        for (size_t g = 0; g < num_genes; ++g) {
+            sum[g] += col[g];
+            sum_sq[g] += col[g] * col[g];
+        }
+
+        ++(diseased ? statistics.num_diseased : statistics.num_healthy);
+        statistics.sample_names.emplace_back(name);
+        statistics.disease_status.push_back(diseased ? 1 : 0);
+        statistics.fingerprints.push_back(column_fingerprints[it->second]);
+        ++added;
+    }
+
+    return added;
+}
+
+vector<size_t> compute_gene_rank(const GroupStatistics& statistics, bool parallel) {
+    if (statistics.num_diseased == 0 || statistics.num_healthy == 0) {
+        throw invalid_argument("Cannot compute gene rank with empty sample groups");
+    }
+
+    size_t num_genes = statistics.num_genes();
+    vector<double> gene_diffs(num_genes);
+    for (size_t g = 0; g < num_genes; ++g) {
+        gene_diffs[g] = statistics.disease_sum[g] / statistics.num_diseased -
+                        statistics.healthy_sum[g] / statistics.num_healthy;
+    }
+
+    vector<uint32_t> order(num_genes);
+    radix_sort_descending(gene_diffs, order, parallel);
+
+    return {order.begin(), order.end()};
+}
+
+void save_group_statistics(const string& filepath, const GroupStatistics& statistics) {
+    string temp_path = filepath + ".tmp";
+    {
+        ofstream out(temp_path, ios::binary | ios::trunc);
+        if (!out) {
+            throw runtime_error(format("Failed to create statistics file: {}", filepath));
+        }
+
+        out.write(kStatisticsMagic.data(), kStatisticsMagic.size());
+        write_pod(out, static_cast<uint64_t>(statistics.num_genes()));
+        write_pod(out, static_cast<uint64_t>(statistics.sample_names.size()));
+        write_pod(out, static_cast<uint64_t>(statistics.num_diseased));
+        write_pod(out, static_cast<uint64_t>(statistics.num_healthy));
+        for (const auto& name : statistics.gene_names) {
+            write_string(out, name);
+        }
+        for (size_t i = 0; i < statistics.sample_names.size(); ++i) {
+            write_string(out, statistics.sample_names[i]);
+            write_pod(out, statistics.disease_status[i]);
+            write_pod(out, statistics.fingerprints[i]);
+        }
+        write_values(out, statistics.disease_sum);
+        write_values(out, statistics.healthy_sum);
+        write_values(out, statistics.disease_sum_sq);
+        write_values(out, statistics.healthy_sum_sq);
+
+        if (!out) {
+            throw runtime_error(format("Failed to write statistics file: {}", filepath));
+        }
+    }
+
+    filesystem::rename(temp_path, filepath);
+}
+
+optional<GroupStatistics> load_group_statistics(const string& filepath) {
+    ifstream in(filepath, ios::binary);
+    if (!in) return nullopt;
+
+    array<char, 8> magic{};
+    uint64_t num_genes = 0;
+    uint64_t num_samples = 0;
+    uint64_t num_diseased = 0;
+    uint64_t num_healthy = 0;
+    if (!in.read(magic.data(), magic.size()) || magic != kStatisticsMagic ||
+        !read_pod(in, num_genes) || !read_pod(in, num_samples) ||
+        !read_pod(in, num_diseased) || !read_pod(in, num_healthy) ||
+        num_diseased + num_healthy != num_samples) {
+        return nullopt;
+    }
+
+    auto file_size = filesystem::file_size(filepath);
+    if (num_genes > file_size || num_samples > file_size) {
+        return nullopt;
+    }
+
+    GroupStatistics statistics;
+    statistics.num_diseased = num_diseased;
+    statistics.num_healthy = num_healthy;
+    statistics.gene_names.resize(num_genes);
+    for (auto& name : statistics.gene_names) {
+        if (!read_string(in, name)) return nullopt;
+    }
+    statistics.sample_names.resize(num_samples);
+    statistics.disease_status.resize(num_samples);
+    statistics.fingerprints.resize(num_samples);
+    for (size_t i = 0; i < num_samples; ++i) {
+        if (!read_string(in, statistics.sample_names[i]) ||
+            !read_pod(in, statistics.disease_status[i]) ||
+            !read_pod(in, statistics.fingerprints[i])) {
+            return nullopt;
+        }
+    }
+    if (!read_values(in, statistics.disease_sum, num_genes) ||
+        !read_values(in, statistics.healthy_sum, num_genes) ||
+        !read_values(in, statistics.disease_sum_sq, num_genes) ||
+        !read_values(in, statistics.healthy_sum_sq, num_genes)) {
+        return nullopt;
+    }
+
+    return statistics;
+}
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "gsea/meta_analysis.h"
+#include "gsea/ranking.h"
+#include "gsea/enrichment.h"
+#include "gsea/statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <format>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+#ifdef USE_PARALLEL_STL
+#include <execution>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+struct CohortRun {
+    vector<double> null_distribution;
+    vector<double> normalized_scores;   // score / mean null score
+    vector<PValueEstimate> estimates;
+    size_t num_samples = 0;
+};
+
+// Survival function of chi-squared with 2k degrees of freedom
+static double chi_squared_even_survival(double x, size_t k) {
+    double half = x / 2.0;
+    double term = 1.0;
+    double sum = 1.0;
+    for (size_t j = 1; j < k; ++j) {
+        term *= half / j;
+        sum += term;
+    }
+    return min(1.0, exp(-half) * sum);
+}
+
+static pair<vector<size_t>, vector<size_t>> group_columns(const Cohort& cohort) {
+    unordered_map<string_view, size_t> column;
+    for (size_t i = 0; i < cohort.expression.num_samples(); ++i) {
+        column.emplace(cohort.expression.sample_names()[i], i);
+    }
+
+    vector<size_t> disease_cols;
+    vector<size_t> healthy_cols;
+    for (size_t i = 0; i < cohort.samples.num_samples(); ++i) {
+        if (auto it = column.find(cohort.samples.sample_names()[i]); it != column.end()) {
+            (cohort.samples.disease_status()[i] == 1 ? disease_cols : healthy_cols)
+                .push_back(it->second);
+        }
+    }
+    return {std::move(disease_cols), std::move(healthy_cols)};
+}
+
+// Ranks, scores and permutes one cohort whose group columns are known
+static void score_cohort(const Cohort& cohort,
+                         span<const GeneSet> sets,
+                         const pair<vector<size_t>, vector<size_t>>& columns,
+                         size_t sample_size,
+                         bool tail_approximation,
+                         CohortRun& run) {
+    const auto& [disease_cols, healthy_cols] = columns;
+    size_t num_sets = sets.size();
+    run.num_samples = disease_cols.size() + healthy_cols.size();
+    if (num_sets == 0) return;
+
+    auto gene_rank = compute_gene_rank(cohort.expression, disease_cols, healthy_cols, true);
+    vector<double> scores(num_sets);
+    score_gene_sets(sets, gene_rank, scores);
+
+    run.null_distribution.resize(sample_size * num_sets);
+    compute_null_distribution(cohort.expression, sets, cohort.samples.num_diseased(),
+                              sample_size, run.null_distribution);
+    run.estimates = estimate_p_values(scores, run.null_distribution, num_sets,
+                                      tail_approximation);
+
+    run.normalized_scores.assign(num_sets, numeric_limits<double>::quiet_NaN());
+    for (size_t i = 0; i < num_sets; ++i) {
+        double null_sum = 0.0;
+        for (size_t sample = 0; sample < sample_size; ++sample) {
+            null_sum += run.null_distribution[sample * num_sets + i];
+        }
+        // Replace each null score by its normalised value for MeanNES
+        double null_mean = null_sum / sample_size;
+        if (null_mean > 0.0) {
+            run.normalized_scores[i] = scores[i] / null_mean;
+            for (size_t sample = 0; sample < sample_size; ++sample) {
+                run.null_distribution[sample * num_sets + i] /= null_mean;
+            }
+        }
+    }
+}
+
+pair<double, double> combine_p_values(span<const PValueEstimate> estimates,
+                                      span<const size_t> num_samples,
+                                      size_t sample_size,
+                                      MetaMethod method) {
+    if (estimates.size() != num_samples.size()) {
+        throw invalid_argument("Need one sample count per cohort estimate");
+    }
+    if (method == MetaMethod::MeanNES) {
+        throw invalid_argument("MeanNES combines scores, not p-values");
+    }
+
+    double min_p = 1.0 / (sample_size + 1.0);
+    double weighted_z = 0.0;
+    double weight_sq = 0.0;
+    double fisher = 0.0;
+    for (size_t c = 0; c < estimates.size(); ++c) {
+        // Only an empirical zero is floored; tail p-values pass through
+        const auto& estimate = estimates[c];
+        double p = estimate.method == PValueMethod::Empirical && estimate.count_greater == 0
+            ? min_p : estimate.p_value;
+        double weight = sqrt(static_cast<double>(num_samples[c]));
+        weighted_z += weight * -normal_quantile(min(p, 1.0 - min_p));
+        weight_sq += weight * weight;
+        fisher += -2.0 * log(p);
+    }
+
+    if (method == MetaMethod::Stouffer) {
+        double z = weighted_z / sqrt(weight_sq);
+        return {z, 0.5 * erfc(z / numbers::sqrt2)};
+    }
+    return {fisher, chi_squared_even_survival(fisher, estimates.size())};
+}
+
+CohortGeneSets resolve_cohort_gene_sets(span<const GeneSetRecord> records,
+                                        span<const Cohort> cohorts,
+                                        const GeneSetFilter& filter) {
+    CohortGeneSets result;
+
+    unordered_map<string_view, uint32_t> union_index;
+    for (const auto& cohort : cohorts) {
+        for (const auto& name : cohort.expression.gene_names()) {
+            if (!union_index.contains(name)) {
+                union_index.emplace(name, static_cast<uint32_t>(result.union_genes.size()));
+                result.union_genes.push_back(name);
+            }
+        }
+    }
+    // Keys must view the final strings, not the cohort buffers
+    union_index.clear();
+    for (size_t i = 0; i < result.union_genes.size(); ++i) {
+        union_index.emplace(result.union_genes[i], static_cast<uint32_t>(i));
+    }
+
+    // Size bounds apply per cohort, after mapping
+    GeneSetFilter union_filter = filter;
+    union_filter.min_size = 1;
+    union_filter.max_size = numeric_limits<size_t>::max();
+    result.union_sets = resolve_gene_sets(records, result.union_genes, union_filter);
+
+    for (const auto& cohort : cohorts) {
+        auto gene_names = cohort.expression.gene_names();
+        size_t num_union = result.union_genes.size();
+
+        // Union gene -> cohort rows, as offsets into a flat row list
+        vector<uint32_t> offsets(num_union + 1, 0);
+        for (const auto& name : gene_names) {
+            ++offsets[union_index.at(name) + 1];
+        }
+        partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        vector<uint32_t> rows(gene_names.size());
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t row = 0; row < gene_names.size(); ++row) {
+            rows[fill[union_index.at(gene_names[row])]++] = static_cast<uint32_t>(row);
+        }
+
+        vector<GeneSet> sets;
+        vector<size_t> set_index;
+        for (size_t s = 0; s < result.union_sets.size(); ++s) {
+            vector<uint32_t> members;
+            for (uint32_t gene : result.union_sets[s].members()) {
+                members.insert(members.end(), rows.begin() + offsets[gene],
+                               rows.begin() + offsets[gene + 1]);
+            }
+            ranges::sort(members);
+
+            if (members.empty() || members.size() < filter.min_size ||
+                members.size() > filter.max_size) {
+                continue;
+            }
+            sets.emplace_back(string(result.union_sets[s].get_name()), std::move(members),
+                              gene_names.size());
+            set_index.push_back(s);
+        }
+
+        result.cohort_sets.push_back(std::move(sets));
+        result.cohort_set_index.push_back(std::move(set_index));
+    }
+
+    return result;
+}
+
+vector<MetaResult> run_meta_analysis(span<const Cohort> cohorts,
+                                     const CohortGeneSets& gene_sets,
+                                     size_t sample_size,
+                                     MetaMethod method,
+                                     bool tail_approximation) {
+    if (cohorts.size() != gene_sets.cohort_sets.size()) {
+        throw invalid_argument("Gene sets were resolved for a different set of cohorts");
+    }
+
+    // Checked up front so that input errors are reported before any work
+    vector<pair<vector<size_t>, vector<size_t>>> columns;
+    columns.reserve(cohorts.size());
+    for (size_t c = 0; c < cohorts.size(); ++c) {
+        columns.push_back(group_columns(cohorts[c]));
+        if (columns[c].first.empty() || columns[c].second.empty()) {
+            throw runtime_error(format(
+                "No matching samples found between sample and expression files of cohort {}",
+                c + 1));
+        }
+        if (cohorts[c].samples.num_diseased() >= cohorts[c].expression.num_samples()) {
+            throw invalid_argument(format(
+                "Cohort {} has no more expression columns than diseased samples", c + 1));
+        }
+    }
+
+    vector<CohortRun> runs(cohorts.size());
+    vector<exception_ptr> errors(cohorts.size());
+    vector<size_t> indices(cohorts.size());
+    iota(indices.begin(), indices.end(), size_t{0});
+
+    // Cohorts run side by side; their permutation loops share the same pool.
+    // An exception escaping a parallel algorithm terminates, so failures are
+    // kept per cohort and rethrown afterwards.
+    auto run_cohort = [&](size_t c) {
+        try {
+            score_cohort(cohorts[c], gene_sets.cohort_sets[c], columns[c], sample_size,
+                         tail_approximation, runs[c]);
+        } catch (...) {
+            errors[c] = current_exception();
+        }
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, indices.begin(), indices.end(), run_cohort);
+#else
+    for_each(indices.begin(), indices.end(), run_cohort);
+#endif
+    for (const auto& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+
+    size_t num_union = gene_sets.union_sets.size();
+    vector<vector<size_t>> local_index(cohorts.size());
+    constexpr size_t kAbsent = numeric_limits<size_t>::max();
+    for (size_t c = 0; c < cohorts.size(); ++c) {
+        local_index[c].assign(num_union, kAbsent);
+        for (size_t i = 0; i < gene_sets.cohort_set_index[c].size(); ++i) {
+            local_index[c][gene_sets.cohort_set_index[c][i]] = i;
+        }
+    }
+
+    vector<MetaResult> results(num_union);
+
+    for (size_t s = 0; s < num_union; ++s) {
+        auto& result = results[s];
+        result = {string(gene_sets.union_sets[s].get_name()), 0,
+                  numeric_limits<double>::quiet_NaN(), 1.0};
+
+        double nes_sum = 0.0;
+        vector<pair<size_t, size_t>> scored;   // (cohort, local set index)
+        vector<PValueEstimate> estimates;
+        vector<size_t> num_samples;
+
+        for (size_t c = 0; c < cohorts.size(); ++c) {
+            size_t i = local_index[c][s];
+            if (i == kAbsent) continue;
+            const auto& run = runs[c];
+
+            if (method == MetaMethod::MeanNES) {
+                if (isnan(run.normalized_scores[i])) continue;
+                nes_sum += run.normalized_scores[i];
+            } else {
+                estimates.push_back(run.estimates[i]);
+                num_samples.push_back(run.num_samples);
+            }
+            scored.emplace_back(c, i);
+        }
+
+        result.num_cohorts = scored.size();
+        if (scored.empty()) continue;
+
+        switch (method) {
+        case MetaMethod::Stouffer:
+        case MetaMethod::Fisher:
+            tie(result.statistic, result.p_value) =
+                combine_p_values(estimates, num_samples, sample_size, method);
+            break;
+        case MetaMethod::MeanNES: {
+            // Permutation p-value of the mean, pairing permutation n across cohorts
+            result.statistic = nes_sum / scored.size();
+            size_t count_greater = 0;
+            for (size_t sample = 0; sample < sample_size; ++sample) {
+                double null_sum = 0.0;
+                for (auto [c, i] : scored) {
+                    null_sum += runs[c].null_distribution[sample * gene_sets.cohort_sets[c].size() + i];
+                }
+                if (null_sum / scored.size() >= result.statistic) {
+                    ++count_greater;
+                }
+            }
+            result.p_value = static_cast<double>(count_greater) / sample_size;
+            break;
+        }
+        }
+    }
+
+    return results;
+}
+
+} // namespace gsea
\ No newline at end of file
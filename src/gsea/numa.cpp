@@ -0,0 +1,192 @@
+#include "gsea/numa.h"
+#include "gsea/gene_set_index.h"
+#include "gsea/statistics.h"
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#ifdef GSEA_HAVE_NUMA
+#include <numa.h>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+vector<NumaNode> numa_topology() {
+    size_t all_cpus = max(thread::hardware_concurrency(), 1u);
+
+#ifdef GSEA_HAVE_NUMA
+    if (numa_available() < 0) {
+        return {{0, all_cpus}};
+    }
+
+    vector<NumaNode> nodes;
+    bitmask* cpus = numa_allocate_cpumask();
+    for (int node = 0; node <= numa_max_node(); ++node) {
+        if (!numa_bitmask_isbitset(numa_all_nodes_ptr, node) ||
+            numa_node_to_cpus(node, cpus) != 0) {
+            continue;
+        }
+        size_t num_cpus = numa_bitmask_weight(cpus);
+        if (num_cpus > 0) {
+            nodes.push_back({node, num_cpus});
+        }
+    }
+    numa_free_cpumask(cpus);
+
+    if (!nodes.empty()) {
+        return nodes;
+    }
+#endif
+
+    return {{0, all_cpus}};
+}
+
+// Binds the calling thread to a node and its allocations to local memory.
+// A no-op without libnuma or for a node it does not know.
+static void bind_to_node(int node) {
+#ifdef GSEA_HAVE_NUMA
+    if (numa_available() >= 0 && node <= numa_max_node()) {
+        numa_run_on_node(node);
+        numa_set_localalloc();
+    }
+#else
+    (void)node;
+#endif
+}
+
+// Runs on a thread bound to the node, so first-touch places the replica's
+// pages in local memory. Rethrows the first exception of any of its workers.
+static void run_node(const NumaNode& node,
+                     const ExpressionData& expression,
+                     span<const GeneSet> gene_sets,
+                     size_t disease_size,
+                     size_t first_sample,
+                     size_t last_sample,
+                     span<double> null_distribution) {
+    bind_to_node(node.id);
+
+    ExpressionData local_expression(
+        Eigen::MatrixXd(expression.values()),
+        vector<string>(expression.gene_names().begin(), expression.gene_names().end()),
+        vector<string>(expression.sample_names().begin(), expression.sample_names().end()));
+
+    GeneSetIndex local_index(gene_sets);
+
+    size_t num_sets = gene_sets.size();
+    size_t num_workers = max<size_t>(node.num_cpus, 1);
+    atomic<size_t> next_sample{first_sample};
+    vector<exception_ptr> errors(num_workers);
+
+    auto worker = [&](size_t w) {
+        try {
+            bind_to_node(node.id);
+            for (size_t sample = next_sample++; sample < last_sample; sample = next_sample++) {
+                auto random_rank = generate_random_gene_rank(local_expression, disease_size);
+                local_index.score_ranking(random_rank,
+                                          null_distribution.subspan(sample * num_sets, num_sets));
+            }
+        } catch (...) {
+            errors[w] = current_exception();
+            // Stop the other workers early
+            next_sample = last_sample;
+        }
+    };
+
+    vector<thread> workers;
+    try {
+        for (size_t w = 1; w < num_workers; ++w) {
+            workers.emplace_back(worker, w);
+        }
+    } catch (...) {
+        errors[0] = current_exception();
+        next_sample = last_sample;
+    }
+    if (!errors[0]) {
+        worker(0);
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    for (const auto& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+void compute_null_distribution_on_nodes(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    size_t disease_size,
+    size_t sample_size,
+    span<const NumaNode> nodes,
+    span<double> null_distribution) {
+
+    if (null_distribution.size() != sample_size * gene_sets.size()) {
+        throw invalid_argument("Null distribution buffer must hold sample_size * num_sets scores");
+    }
+    if (disease_size >= expression.num_samples()) {
+        throw invalid_argument("Disease size must be less than total number of samples");
+    }
+    if (nodes.empty()) {
+        throw invalid_argument("At least one node is required");
+    }
+    if (gene_sets.empty()) return;
+
+    size_t total_cpus = 0;
+    for (const auto& node : nodes) {
+        total_cpus += max<size_t>(node.num_cpus, 1);
+    }
+
+    // Permutation blocks proportional to each node's CPU count
+    vector<thread> leaders;
+    vector<exception_ptr> errors(nodes.size());
+    size_t first_sample = 0;
+    size_t cpus_before = 0;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        cpus_before += max<size_t>(nodes[n].num_cpus, 1);
+        size_t last_sample = sample_size * cpus_before / total_cpus;
+        try {
+            leaders.emplace_back([&, n, first_sample, last_sample] {
+                try {
+                    run_node(nodes[n], expression, gene_sets, disease_size,
+                             first_sample, last_sample, null_distribution);
+                } catch (...) {
+                    errors[n] = current_exception();
+                }
+            });
+        } catch (...) {
+            errors[n] = current_exception();
+            break;
+        }
+        first_sample = last_sample;
+    }
+
+    for (auto& leader : leaders) {
+        leader.join();
+    }
+    for (const auto& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+void compute_null_distribution_numa(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    size_t disease_size,
+    size_t sample_size,
+    span<double> null_distribution) {
+
+    auto nodes = numa_topology();
+    if (nodes.size() > 1) {
+        compute_null_distribution_on_nodes(expression, gene_sets, disease_size, sample_size,
+                                           nodes, null_distribution);
+        return;
+    }
+
+    compute_null_distribution(expression, gene_sets, disease_size, sample_size,
+                              null_distribution);
+}
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "gsea/overlap.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef USE_PARALLEL_STL
+#include <execution>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+// Sets per tile side and words per block: a tile pair streams 2 x 32 rows of
+// 2 KiB blocks, which stays within L1/L2 while the 32 x 32 counts accumulate.
+static constexpr size_t kTileSets = 32;
+static constexpr size_t kBlockWords = 256;
+
+// Bit-packed membership rows, one per set, over ceil(num_genes / 64) words
+class MembershipBits {
+public:
+    explicit MembershipBits(span<const GeneSet> gene_sets)
+        : num_words_(gene_sets.empty() ? 0 : (gene_sets.front().num_genes() + 63) / 64)
+        , bits_(gene_sets.size() * num_words_, 0) {
+        for (size_t s = 0; s < gene_sets.size(); ++s) {
+            if ((gene_sets[s].num_genes() + 63) / 64 != num_words_) {
+                throw invalid_argument("Gene sets must be resolved against the same genes");
+            }
+            uint64_t* row = bits_.data() + s * num_words_;
+            for (uint32_t idx : gene_sets[s].members()) {
+                row[idx / 64] |= uint64_t{1} << (idx % 64);
+            }
+        }
+    }
+
+    [[nodiscard]] const uint64_t* row(size_t set) const noexcept {
+        return bits_.data() + set * num_words_;
+    }
+    [[nodiscard]] size_t num_words() const noexcept { return num_words_; }
+
+private:
+    size_t num_words_;
+    vector<uint64_t> bits_;
+};
+
+// x86 builds carry a second copy of the tile kernel compiled for the POPCNT
+// instruction, picked at runtime; elsewhere popcount is the portable one
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GSEA_POPCNT_DISPATCH
+#define GSEA_ALWAYS_INLINE [[gnu::always_inline]] inline
+#else
+#define GSEA_ALWAYS_INLINE inline
+#endif
+
+using TileCounts = array<array<uint32_t, kTileSets>, kTileSets>;
+
+GSEA_ALWAYS_INLINE uint32_t intersection_size(const uint64_t* a, const uint64_t* b,
+                                              size_t num_words) {
+    uint32_t count = 0;
+    for (size_t w = 0; w < num_words; ++w) {
+        count += popcount(a[w] & b[w]);
+    }
+    return count;
+}
+
+// counts[i][j] = |rows[i] & cols[j]|, streamed a block of words at a time;
+// with upper_triangle only pairs where rows[i] <= cols[j] are counted
+GSEA_ALWAYS_INLINE void count_tile(const MembershipBits& bits,
+                                   span<const size_t> rows,
+                                   span<const size_t> cols,
+                                   bool upper_triangle,
+                                   TileCounts& counts) {
+    size_t num_words = bits.num_words();
+    counts = {};
+    for (size_t w0 = 0; w0 < num_words; w0 += kBlockWords) {
+        size_t block = min(kBlockWords, num_words - w0);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const uint64_t* a = bits.row(rows[i]) + w0;
+            for (size_t j = 0; j < cols.size(); ++j) {
+                if (upper_triangle && cols[j] < rows[i]) continue;
+                counts[i][j] += intersection_size(a, bits.row(cols[j]) + w0, block);
+            }
+        }
+    }
+}
+
+using TileKernel = void (*)(const MembershipBits&, span<const size_t>, span<const size_t>,
+                            bool, TileCounts&);
+
+static void count_tile_portable(const MembershipBits& bits, span<const size_t> rows,
+                                span<const size_t> cols, bool upper_triangle,
+                                TileCounts& counts) {
+    count_tile(bits, rows, cols, upper_triangle, counts);
+}
+
+#ifdef GSEA_POPCNT_DISPATCH
+[[gnu::target("popcnt")]]
+static void count_tile_popcnt(const MembershipBits& bits, span<const size_t> rows,
+                              span<const size_t> cols, bool upper_triangle,
+                              TileCounts& counts) {
+    count_tile(bits, rows, cols, upper_triangle, counts);
+}
+#endif
+
+static TileKernel tile_kernel() {
+    static const TileKernel kernel = [] {
+#ifdef GSEA_POPCNT_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("popcnt")) return &count_tile_popcnt;
+#endif
+        return &count_tile_portable;
+    }();
+    return kernel;
+}
+
+static double similarity(uint32_t intersection, size_t size_a, size_t size_b,
+                         OverlapMetric metric) {
+    double denom = metric == OverlapMetric::Jaccard
+        ? static_cast<double>(size_a + size_b - intersection)
+        : static_cast<double>(min(size_a, size_b));
+    return denom > 0.0 ? intersection / denom : 0.0;
+}
+
+IntersectionMatrix compute_intersections(span<const GeneSet> gene_sets) {
+    size_t num_sets = gene_sets.size();
+    MembershipBits bits(gene_sets);
+
+    IntersectionMatrix intersections(num_sets, num_sets);
+
+    size_t num_tiles = (num_sets + kTileSets - 1) / kTileSets;
+    vector<size_t> row_tiles(num_tiles);
+    iota(row_tiles.begin(), row_tiles.end(), size_t{0});
+
+    auto kernel = tile_kernel();
+    auto count_row_tile = [&](size_t ti) {
+        array<size_t, kTileSets> rows;
+        array<size_t, kTileSets> cols;
+        size_t row_begin = ti * kTileSets;
+        size_t num_rows = min(kTileSets, num_sets - row_begin);
+        iota(rows.begin(), rows.begin() + num_rows, row_begin);
+
+        // Upper triangle only, including the diagonal tile
+        TileCounts counts;
+        for (size_t tj = ti; tj < num_tiles; ++tj) {
+            size_t col_begin = tj * kTileSets;
+            size_t num_cols = min(kTileSets, num_sets - col_begin);
+            iota(cols.begin(), cols.begin() + num_cols, col_begin);
+
+            kernel(bits, span(rows.data(), num_rows), span(cols.data(), num_cols), true, counts);
+            for (size_t i = 0; i < num_rows; ++i) {
+                for (size_t j = 0; j < num_cols; ++j) {
+                    if (col_begin + j >= row_begin + i) {
+                        intersections(row_begin + i, col_begin + j) = counts[i][j];
+                    }
+                }
+            }
+        }
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, row_tiles.begin(), row_tiles.end(), count_row_tile);
+#else
+    for_each(row_tiles.begin(), row_tiles.end(), count_row_tile);
+#endif
+
+    for (size_t i = 0; i < num_sets; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            intersections(i, j) = intersections(j, i);
+        }
+    }
+
+    return intersections;
+}
+
+ScoreMatrix compute_similarity(const IntersectionMatrix& intersections,
+                               OverlapMetric metric) {
+    Eigen::Index num_sets = intersections.rows();
+    ScoreMatrix scores(num_sets, num_sets);
+    for (Eigen::Index i = 0; i < num_sets; ++i) {
+        for (Eigen::Index j = 0; j < num_sets; ++j) {
+            scores(i, j) = similarity(intersections(i, j), intersections(i, i),
+                                      intersections(j, j), metric);
+        }
+    }
+    return scores;
+}
+
+// Bit i is set when candidates[i] is at least threshold-similar to any of
+// kept; both spans hold at most one tile of sets.
+static uint32_t redundant_mask(const MembershipBits& bits,
+                               span<const GeneSet> gene_sets,
+                               span<const size_t> candidates,
+                               span<const size_t> kept,
+                               double threshold,
+                               OverlapMetric metric) {
+    static_assert(kTileSets <= 32, "redundancy masks hold one bit per tile set");
+
+    TileCounts counts;
+    tile_kernel()(bits, candidates, kept, false, counts);
+
+    uint32_t mask = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        for (size_t j = 0; j < kept.size(); ++j) {
+            if (similarity(counts[i][j], gene_sets[candidates[i]].size(),
+                           gene_sets[kept[j]].size(), metric) >= threshold) {
+                mask |= uint32_t{1} << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+vector<size_t> select_nonredundant_sets(span<const GeneSet> gene_sets,
+                                        double threshold,
+                                        OverlapMetric metric) {
+    MembershipBits bits(gene_sets);
+
+    vector<size_t> by_size(gene_sets.size());
+    iota(by_size.begin(), by_size.end(), size_t{0});
+    ranges::stable_sort(by_size, ranges::greater{},
+                        [&](size_t s) { return gene_sets[s].size(); });
+
+    // Candidates advance a tile at a time: the tile is tested against every
+    // tile of sets already kept with the blocked kernel, in parallel, and
+    // the survivors are then filtered against each other in size order.
+    vector<size_t> kept;
+    vector<size_t> kept_tiles;
+    for (size_t begin = 0; begin < by_size.size(); begin += kTileSets) {
+        span<const size_t> candidates(by_size.data() + begin,
+                                      min(kTileSets, by_size.size() - begin));
+
+        kept_tiles.resize((kept.size() + kTileSets - 1) / kTileSets);
+        iota(kept_tiles.begin(), kept_tiles.end(), size_t{0});
+        auto tile_mask = [&](size_t tile) {
+            size_t first = tile * kTileSets;
+            span<const size_t> others(kept.data() + first,
+                                      min(kTileSets, kept.size() - first));
+            return redundant_mask(bits, gene_sets, candidates, others, threshold, metric);
+        };
+#ifdef USE_PARALLEL_STL
+        uint32_t redundant = transform_reduce(execution::par,
+                                              kept_tiles.begin(), kept_tiles.end(),
+                                              uint32_t{0}, bit_or<>{}, tile_mask);
+#else
+        uint32_t redundant = transform_reduce(kept_tiles.begin(), kept_tiles.end(),
+                                              uint32_t{0}, bit_or<>{}, tile_mask);
+#endif
+
+        size_t tile_start = kept.size();
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (redundant & (uint32_t{1} << i)) {
+                continue;
+            }
+            span<const size_t> earlier(kept.data() + tile_start, kept.size() - tile_start);
+            if (redundant_mask(bits, gene_sets, candidates.subspan(i, 1), earlier,
+                               threshold, metric) == 0) {
+                kept.push_back(candidates[i]);
+            }
+        }
+    }
+
+    ranges::sort(kept);
+    return kept;
+}
+
+vector<size_t> find_identical_sets(span<const GeneSet> gene_sets) {
+    vector<size_t> representative(gene_sets.size());
+    vector<vector<uint32_t>> sorted_members(gene_sets.size());
+    unordered_map<uint64_t, vector<size_t>> by_hash;
+
+    for (size_t s = 0; s < gene_sets.size(); ++s) {
+        auto& members = sorted_members[s];
+        members.assign(gene_sets[s].members().begin(), gene_sets[s].members().end());
+        ranges::sort(members);
+
+        // FNV-1a over the sorted member indices
+        uint64_t hash = 1469598103934665603ull;
+        for (uint32_t idx : members) {
+            hash = (hash ^ idx) * 1099511628211ull;
+        }
+
+        representative[s] = s;
+        auto& candidates = by_hash[hash];
+        for (size_t other : candidates) {
+            if (sorted_members[other] == members) {
+                representative[s] = other;
+                break;
+            }
+        }
+        if (representative[s] == s) {
+            candidates.push_back(s);
+        }
+    }
+
+    return representative;
+}
+
+} // namespace gsea
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "gsea/permutation_store.h"
+#include "gsea/statistics.h"
+#include "gsea/ranking.h"
+#include "gsea/gene_set_index.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef USE_PARALLEL_STL
+#include <execution>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr array<char, 8> kStoreMagic = {'G', 'S', 'E', 'A', 'P', 'R', 'M', '1'};
+
+// Permutations generated and appended per batch, bounding the staging buffer
+static constexpr size_t kAppendBatch = 256;
+
+struct StoreHeader {
+    array<char, 8> magic;
+    uint64_t fingerprint;
+    uint64_t seed;
+    uint64_t num_genes;
+    uint64_t num_permutations;
+    uint32_t index_bytes;
+    uint32_t reserved;
+};
+static_assert(sizeof(StoreHeader) == 48);
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t fingerprint_permutation_inputs(const ExpressionData& expression,
+                                        size_t disease_size) {
+    // Every column is shuffled, so sample labels and names do not matter
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint64_t shape[3] = {expression.num_genes(), expression.num_samples(), disease_size};
+    hash = fnv1a(hash, shape, sizeof(shape));
+
+    auto values = expression.values();
+    for (Eigen::Index col = 0; col < values.cols(); ++col) {
+        hash = fnv1a(hash, values.col(col).data(), values.rows() * sizeof(double));
+    }
+    for (const auto& name : expression.gene_names()) {
+        hash = fnv1a(hash, name.data(), name.size() + 1);
+    }
+
+    return hash;
+}
+
+// Read-only view of a file's first size bytes, or nullptr on failure
+static void* map_file(const string& path, size_t size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return nullptr;
+    }
+    // The view keeps the mapping alive after its handle is closed
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    return view;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+#endif
+}
+
+static void unmap_file(void* mapping, size_t size) noexcept {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+// Exclusive lock on a file next to the store, held while the store is
+// checked and extended so that concurrent opens append each row once
+class StoreLock {
+public:
+    explicit StoreLock(const string& path) {
+#ifdef _WIN32
+        handle_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+        OVERLAPPED whole{};
+        if (handle_ == INVALID_HANDLE_VALUE ||
+            !LockFileEx(handle_, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &whole)) {
+            if (handle_ != INVALID_HANDLE_VALUE) {
+                CloseHandle(handle_);
+            }
+            throw runtime_error(format("Failed to lock permutation store: {}", path));
+        }
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0 || flock(fd_, LOCK_EX) != 0) {
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+            throw runtime_error(format("Failed to lock permutation store: {}", path));
+        }
+#endif
+    }
+
+    ~StoreLock() {
+#ifdef _WIN32
+        OVERLAPPED whole{};
+        UnlockFileEx(handle_, 0, MAXDWORD, MAXDWORD, &whole);
+        CloseHandle(handle_);
+#else
+        flock(fd_, LOCK_UN);
+        ::close(fd_);
+#endif
+    }
+
+    StoreLock(const StoreLock&) = delete;
+    StoreLock& operator=(const StoreLock&) = delete;
+
+private:
+#ifdef _WIN32
+    HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+};
+
+static string store_path(const string& directory, uint64_t fingerprint, uint64_t seed) {
+    return (filesystem::path(directory) / format("{:016x}-{}.perm", fingerprint, seed)).string();
+}
+
+static void write_header(fstream& file, const StoreHeader& header) {
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// Generates permutations [first, last) and appends their gene positions
+static void append_permutations(fstream& file,
+                                const ExpressionData& expression,
+                                size_t disease_size,
+                                uint64_t seed,
+                                uint32_t index_bytes,
+                                size_t first,
+                                size_t last) {
+    size_t num_genes = expression.num_genes();
+    size_t row_bytes = num_genes * index_bytes;
+    vector<unsigned char> rows((last - first) * row_bytes);
+
+    vector<size_t> indices(last - first);
+    iota(indices.begin(), indices.end(), size_t{0});
+
+    auto generate = [&](size_t i) {
+        auto rank = generate_random_gene_rank(expression, disease_size, seed, first + i);
+        vector<uint32_t> position(num_genes);
+        invert_gene_rank(rank, position);
+
+        unsigned char* row = rows.data() + i * row_bytes;
+        if (index_bytes == sizeof(uint16_t)) {
+            for (size_t g = 0; g < num_genes; ++g) {
+                auto narrow = static_cast<uint16_t>(position[g]);
+                memcpy(row + g * sizeof(uint16_t), &narrow, sizeof(uint16_t));
+            }
+        } else {
+            memcpy(row, position.data(), row_bytes);
+        }
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, indices.begin(), indices.end(), generate);
+#else
+    for_each(indices.begin(), indices.end(), generate);
+#endif
+
+    file.seekp(static_cast<streamoff>(sizeof(StoreHeader) + first * row_bytes));
+    file.write(reinterpret_cast<const char*>(rows.data()), static_cast<streamsize>(rows.size()));
+}
+
+PermutationStore PermutationStore::open(const string& directory,
+                                        const ExpressionData& expression,
+                                        size_t disease_size,
+                                        uint64_t seed,
+                                        size_t sample_size) {
+    if (disease_size == 0 || disease_size >= expression.num_samples()) {
+        throw invalid_argument("Disease size must be between 1 and the number of samples - 1");
+    }
+
+    size_t num_genes = expression.num_genes();
+    uint64_t fingerprint = fingerprint_permutation_inputs(expression, disease_size);
+    uint32_t index_bytes = num_genes <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    filesystem::create_directories(directory);
+    string path = store_path(directory, fingerprint, seed);
+
+    StoreHeader header{kStoreMagic, fingerprint, seed, num_genes, 0, index_bytes, 0};
+    {
+        StoreLock lock(path + ".lock");
+        fstream file(path, ios::binary | ios::in | ios::out);
+        if (file) {
+            StoreHeader stored{};
+            file.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+            if (!file || stored.magic != kStoreMagic || stored.fingerprint != fingerprint ||
+                stored.seed != seed || stored.num_genes != num_genes ||
+                stored.index_bytes != index_bytes) {
+                throw runtime_error(format("Permutation store is corrupt or foreign: {}", path));
+            }
+
+            // Rows past a crash-truncated tail are not counted in the header
+            header.num_permutations = stored.num_permutations;
+            auto file_size = filesystem::file_size(path);
+            if (file_size < sizeof(StoreHeader) + header.num_permutations * num_genes * index_bytes) {
+                throw runtime_error(format("Permutation store is truncated: {}", path));
+            }
+        } else {
+            file.clear();
+            file.open(path, ios::binary | ios::out | ios::trunc);
+            if (!file) {
+                throw runtime_error(format("Failed to create permutation store: {}", path));
+            }
+            write_header(file, header);
+            file.close();
+            file.open(path, ios::binary | ios::in | ios::out);
+        }
+
+        // Extend in batches, committing the count after each so an
+        // interrupted run keeps what it finished
+        while (header.num_permutations < sample_size) {
+            size_t first = header.num_permutations;
+            size_t last = min(sample_size, first + kAppendBatch);
+            append_permutations(file, expression, disease_size, seed, index_bytes, first, last);
+            file.flush();
+
+            header.num_permutations = last;
+            write_header(file, header);
+            file.flush();
+            if (!file) {
+                throw runtime_error(format("Failed to write permutation store: {}", path));
+            }
+        }
+    }
+
+    PermutationStore store;
+    store.num_genes_ = num_genes;
+    store.num_permutations_ = header.num_permutations;
+    store.index_bytes_ = index_bytes;
+    store.mapping_size_ = sizeof(StoreHeader) + header.num_permutations * num_genes * index_bytes;
+
+    // Rows are never rewritten once counted, so the mapping stays valid
+    // while other processes extend the file
+    void* mapping = map_file(path, store.mapping_size_);
+    if (!mapping) {
+        throw runtime_error(format("Failed to map permutation store: {}", path));
+    }
+
+    store.mapping_ = mapping;
+    store.data_ = static_cast<const unsigned char*>(mapping) + sizeof(StoreHeader);
+    return store;
+}
+
+PermutationStore::~PermutationStore() {
+    unmap();
+}
+
+PermutationStore::PermutationStore(PermutationStore&& other) noexcept
+    : data_(exchange(other.data_, nullptr)),
+      mapping_(exchange(other.mapping_, nullptr)),
+      mapping_size_(exchange(other.mapping_size_, 0)),
+      num_genes_(other.num_genes_),
+      num_permutations_(other.num_permutations_),
+      index_bytes_(other.index_bytes_) {
+}
+
+PermutationStore& PermutationStore::operator=(PermutationStore&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = exchange(other.data_, nullptr);
+        mapping_ = exchange(other.mapping_, nullptr);
+        mapping_size_ = exchange(other.mapping_size_, 0);
+        num_genes_ = other.num_genes_;
+        num_permutations_ = other.num_permutations_;
+        index_bytes_ = other.index_bytes_;
+    }
+    return *this;
+}
+
+void PermutationStore::unmap() noexcept {
+    if (mapping_) {
+        unmap_file(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        data_ = nullptr;
+    }
+}
+
+void PermutationStore::gene_positions(size_t permutation, span<uint32_t> positions) const {
+    if (permutation >= num_permutations_) {
+        throw out_of_range(format("Permutation {} is not in the store ({} stored)",
+                                  permutation, num_permutations_));
+    }
+    if (positions.size() != num_genes_) {
+        throw invalid_argument("Position buffer size must match the number of genes");
+    }
+
+    const unsigned char* row = data_ + permutation * num_genes_ * index_bytes_;
+    if (index_bytes_ == sizeof(uint16_t)) {
+        for (size_t g = 0; g < num_genes_; ++g) {
+            uint16_t narrow;
+            memcpy(&narrow, row + g * sizeof(uint16_t), sizeof(uint16_t));
+            positions[g] = narrow;
+        }
+    } else {
+        memcpy(positions.data(), row, num_genes_ * sizeof(uint32_t));
+    }
+}
+
+void PermutationStore::score(span<const GeneSet> gene_sets,
+                             size_t sample_size,
+                             span<double> null_distribution) const {
+    size_t num_sets = gene_sets.size();
+    if (sample_size > num_permutations_) {
+        throw invalid_argument(format("Store holds {} permutations, {} requested",
+                                      num_permutations_, sample_size));
+    }
+    if (null_distribution.size() != sample_size * num_sets) {
+        throw invalid_argument("Null distribution buffer must hold sample_size * num_sets scores");
+    }
+    for (const auto& gene_set : gene_sets) {
+        if (gene_set.num_genes() != num_genes_) {
+            throw invalid_argument(format(
+                "Gene set '{}' was resolved against {} genes, store has {}",
+                gene_set.get_name(), gene_set.num_genes(), num_genes_));
+        }
+    }
+    if (num_sets == 0) return;
+
+    GeneSetIndex index(gene_sets);
+
+    vector<size_t> indices(sample_size);
+    iota(indices.begin(), indices.end(), size_t{0});
+
+    auto score_permutation = [&](size_t sample) {
+        vector<uint32_t> position(num_genes_);
+        gene_positions(sample, position);
+        index.score(position, null_distribution.subspan(sample * num_sets, num_sets));
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, indices.begin(), indices.end(), score_permutation);
+#else
+    for_each(indices.begin(), indices.end(), score_permutation);
+#endif
+}
+
+} // namespace gsea
\ No newline at end of file
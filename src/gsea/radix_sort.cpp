@@ -0,0 +1,132 @@
+#include "gsea/radix_sort.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef USE_PARALLEL_STL
+#include <execution>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr unsigned kDigitBits = 11;
+static constexpr size_t kBuckets = size_t{1} << kDigitBits;
+static constexpr unsigned kPasses = (64 + kDigitBits - 1) / kDigitBits;
+
+// Below this size a parallel pass costs more than it saves
+static constexpr size_t kMinParallelSize = size_t{1} << 16;
+
+using Histogram = array<uint32_t, kBuckets>;
+
+uint64_t order_key(double value) noexcept {
+    if (value == 0.0) value = 0.0;
+    auto bits = bit_cast<uint64_t>(value);
+    constexpr uint64_t sign = uint64_t{1} << 63;
+    return (bits & sign) ? ~bits : bits | sign;
+}
+
+static size_t digit(uint64_t key, unsigned pass) {
+    return (key >> (pass * kDigitBits)) & (kBuckets - 1);
+}
+
+// One stable counting pass over [begin, end) using precomputed bucket
+// offsets, which are advanced in place.
+static void scatter(span<const uint64_t> keys, span<const uint32_t> order,
+                    span<uint64_t> keys_out, span<uint32_t> order_out,
+                    size_t begin, size_t end, unsigned pass, Histogram& offsets) {
+    for (size_t i = begin; i < end; ++i) {
+        size_t slot = offsets[digit(keys[i], pass)]++;
+        keys_out[slot] = keys[i];
+        order_out[slot] = order[i];
+    }
+}
+
+void radix_sort_descending(span<const double> scores,
+                           span<uint32_t> order,
+                           [[maybe_unused]] bool parallel) {
+    size_t n = scores.size();
+    if (order.size() != n) {
+        throw invalid_argument("Order buffer size must match the number of scores");
+    }
+
+    // Complemented keys sort ascending in descending score order; starting
+    // from index order makes the stable passes break ties by index.
+    vector<uint64_t> keys(n);
+    vector<uint64_t> keys_tmp(n);
+    vector<uint32_t> order_tmp(n);
+    ranges::transform(scores, keys.begin(), [](double score) { return ~order_key(score); });
+    iota(order.begin(), order.end(), uint32_t{0});
+
+    span<uint64_t> keys_in = keys;
+    span<uint64_t> keys_out = keys_tmp;
+    span<uint32_t> order_in = order;
+    span<uint32_t> order_out = order_tmp;
+
+    size_t num_chunks = 1;
+#ifdef USE_PARALLEL_STL
+    if (parallel && n >= kMinParallelSize) {
+        num_chunks = max(thread::hardware_concurrency(), 1u);
+    }
+#endif
+    size_t chunk_size = (n + num_chunks - 1) / max<size_t>(num_chunks, 1);
+    vector<Histogram> histograms(num_chunks);
+    vector<size_t> chunks(num_chunks);
+    iota(chunks.begin(), chunks.end(), size_t{0});
+
+    for (unsigned pass = 0; pass < kPasses; ++pass) {
+        auto count = [&](size_t chunk) {
+            auto& histogram = histograms[chunk];
+            histogram.fill(0);
+            size_t end = min(n, (chunk + 1) * chunk_size);
+            for (size_t i = chunk * chunk_size; i < end; ++i) {
+                ++histogram[digit(keys_in[i], pass)];
+            }
+        };
+#ifdef USE_PARALLEL_STL
+        for_each(execution::par, chunks.begin(), chunks.end(), count);
+#else
+        for_each(chunks.begin(), chunks.end(), count);
+#endif
+
+        // Bucket-major, chunk-minor offsets keep the pass stable
+        size_t running = 0;
+        bool trivial = false;
+        for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+            size_t bucket_total = 0;
+            for (auto& histogram : histograms) {
+                uint32_t bucket_count = histogram[bucket];
+                histogram[bucket] = static_cast<uint32_t>(running);
+                running += bucket_count;
+                bucket_total += bucket_count;
+            }
+            trivial = trivial || bucket_total == n;
+        }
+        if (trivial) continue;
+
+        auto distribute = [&](size_t chunk) {
+            size_t end = min(n, (chunk + 1) * chunk_size);
+            scatter(keys_in, order_in, keys_out, order_out,
+                    chunk * chunk_size, end, pass, histograms[chunk]);
+        };
+#ifdef USE_PARALLEL_STL
+        for_each(execution::par, chunks.begin(), chunks.end(), distribute);
+#else
+        for_each(chunks.begin(), chunks.end(), distribute);
+#endif
+
+        swap(keys_in, keys_out);
+        swap(order_in, order_out);
+    }
+
+    if (order_in.data() != order.data()) {
+        ranges::copy(order_in, order.begin());
+    }
+}
+
+} // namespace gsea
\ No newline at end of file
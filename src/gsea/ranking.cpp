@@ -1,4 +1,5 @@
 #include "gsea/ranking.h"
+#include "gsea/radix_sort.h"
 #include <algorithm>
 #include <stdexcept>
 #include <numeric>
@@ -10,43 +11,57 @@ namespace gsea {
 static double calculate_mean(const ExpressionData& expression,
                              size_t gene_idx,
                              span<const size_t> sample_indices) {
+    auto values = expression.values();
     double sum = accumulate(sample_indices.begin(), sample_indices.end(), 0.0,
         [&](double acc, size_t col) {
-            return acc + expression.values()(gene_idx, col);
+            return acc + values(gene_idx, col);
         });
     return sum / sample_indices.size();
 }
 
 vector<size_t> compute_gene_rank(const ExpressionData& expression,
                                        span<const size_t> disease_indices,
-                                       span<const size_t> healthy_indices) {
+                                       span<const size_t> healthy_indices,
+                                       bool parallel) {
+    vector<size_t> ranked_indices(expression.num_genes());
+    compute_gene_rank(expression, disease_indices, healthy_indices, ranked_indices, parallel);
+    return ranked_indices;
+}
+
+void compute_gene_rank(const ExpressionData& expression,
+                       span<const size_t> disease_indices,
+                       span<const size_t> healthy_indices,
+                       span<size_t> ranked_indices,
+                       bool parallel) {
     if (disease_indices.empty() || healthy_indices.empty()) {
         throw invalid_argument("Cannot compute gene rank with empty sample groups");
     }
 
     size_t num_genes = expression.num_genes();
+    if (ranked_indices.size() != num_genes) {
+        throw invalid_argument("Rank buffer size must match the number of genes");
+    }
 
     // Calculate differential expression for each gene
-    vector<pair<size_t, double>> gene_diffs;
-    gene_diffs.reserve(num_genes);
+    vector<double> gene_diffs(num_genes);
 
     for (size_t gene_idx = 0; gene_idx < num_genes; ++gene_idx) {
         double disease_mean = calculate_mean(expression, gene_idx, disease_indices);
         double healthy_mean = calculate_mean(expression, gene_idx, healthy_indices);
-        gene_diffs.emplace_back(gene_idx, disease_mean - healthy_mean);
+        gene_diffs[gene_idx] = disease_mean - healthy_mean;
     }
 
     // Sort by difference in descending order
-    ranges::sort(gene_diffs, ranges::greater{}, &pair<size_t, double>::second);
+    vector<uint32_t> order(num_genes);
+    radix_sort_descending(gene_diffs, order, parallel);
 
-    // Extract indices
-    vector<size_t> ranked_indices;
-    ranked_indices.reserve(num_genes);
-    for (const auto& [idx, _] : gene_diffs) {
-        ranked_indices.push_back(idx);
-    }
+    ranges::copy(order, ranked_indices.begin());
+}
 
-    return ranked_indices;
+void invert_gene_rank(span<const size_t> gene_rank, span<uint32_t> gene_position) {
+    for (size_t i = 0; i < gene_rank.size(); ++i) {
+        gene_position[gene_rank[i]] = static_cast<uint32_t>(i);
+    }
 }
 
 } // namespace gsea
\ No newline at end of file
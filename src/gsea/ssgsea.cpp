@@ -0,0 +1,114 @@
+#include "gsea/ssgsea.h"
+#include "gsea/radix_sort.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#ifdef USE_PARALLEL_STL
+#include <execution>
+#endif
+
+using namespace std;
+
+namespace gsea {
+
+// Samples ranked by one task; buffers are reused across a block
+static constexpr size_t kSampleBlock = 8;
+
+// Scores a set from its members' rank positions, gathered into the
+// caller's hits buffer so that it is reused across sets and samples
+static double score_set(const GeneSet& gene_set,
+                        span<const uint32_t> gene_position,
+                        double alpha,
+                        vector<uint32_t>& hits) {
+    size_t num_genes = gene_position.size();
+    auto members = gene_set.members();
+    hits.resize(members.size());
+    ranges::transform(members, hits.begin(), [&](uint32_t idx) { return gene_position[idx]; });
+    ranges::sort(hits);
+
+    // The running sums are step functions between hits, so each sum over
+    // all positions reduces to a sum over the hits:
+    //   sum_i P_hit(i)  = sum_j cumulative_weight_j * (next_hit_j - hit_j) / total
+    //   sum_i misses(i) = N (N + 1) / 2 - sum_j (N - hit_j)
+    double weighted_area = 0.0;
+    double cumulative_weight = 0.0;
+    double hit_area = 0.0;
+    for (size_t j = 0; j < hits.size(); ++j) {
+        // Rank statistic: N for the highest-expressed gene down to 1
+        cumulative_weight += pow(static_cast<double>(num_genes - hits[j]), alpha);
+        size_t next = j + 1 < hits.size() ? hits[j + 1] : num_genes;
+        weighted_area += cumulative_weight * static_cast<double>(next - hits[j]);
+        hit_area += static_cast<double>(num_genes - hits[j]);
+    }
+
+    double hit_sum = weighted_area / cumulative_weight;
+
+    size_t num_misses = num_genes - hits.size();
+    if (num_misses == 0) {
+        return hit_sum;
+    }
+    double n = static_cast<double>(num_genes);
+    double miss_sum = (n * (n + 1.0) / 2.0 - hit_area) / static_cast<double>(num_misses);
+
+    return hit_sum - miss_sum;
+}
+
+double calculate_ssgsea_score(const GeneSet& gene_set,
+                              span<const uint32_t> gene_position,
+                              double alpha) {
+    vector<uint32_t> hits;
+    return score_set(gene_set, gene_position, alpha, hits);
+}
+
+ScoreMatrix compute_ssgsea(const ExpressionData& expression,
+                           span<const GeneSet> gene_sets,
+                           double alpha) {
+    size_t num_genes = expression.num_genes();
+    size_t num_samples = expression.num_samples();
+    for (const auto& gene_set : gene_sets) {
+        if (gene_set.num_genes() != num_genes) {
+            throw invalid_argument("Gene sets must be resolved against the expression genes");
+        }
+    }
+
+    ScoreMatrix scores(num_samples, gene_sets.size());
+    auto values = expression.values();
+
+    vector<size_t> blocks((num_samples + kSampleBlock - 1) / kSampleBlock);
+    iota(blocks.begin(), blocks.end(), size_t{0});
+
+    auto score_block = [&](size_t block) {
+        vector<double> column(num_genes);
+        vector<uint32_t> order(num_genes);
+        vector<uint32_t> gene_position(num_genes);
+        vector<uint32_t> hits;
+
+        size_t end = min(num_samples, (block + 1) * kSampleBlock);
+        for (size_t sample = block * kSampleBlock; sample < end; ++sample) {
+            for (size_t gene = 0; gene < num_genes; ++gene) {
+                column[gene] = values(gene, sample);
+            }
+            radix_sort_descending(column, order);
+            for (size_t i = 0; i < num_genes; ++i) {
+                gene_position[order[i]] = static_cast<uint32_t>(i);
+            }
+
+            for (size_t s = 0; s < gene_sets.size(); ++s) {
+                scores(sample, s) = score_set(gene_sets[s], gene_position, alpha, hits);
+            }
+        }
+    };
+
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, blocks.begin(), blocks.end(), score_block);
+#else
+    for_each(blocks.begin(), blocks.end(), score_block);
+#endif
+
+    return scores;
+}
+
+} // namespace gsea
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "gsea/statistics.h"
 #include "gsea/ranking.h"
-#include "gsea/enrichment.h"
+#include "gsea/gene_set_index.h"
 #include <random>
+#include <cmath>
+#include <format>
+#include <numbers>
 #include <algorithm>
 #include <stdexcept>
+#include <numeric>
 
 #ifdef USE_PARALLEL_STL
 #include <execution>
@@ -13,8 +17,13 @@ using namespace std;
 
 namespace gsea {
 
-vector<size_t> generate_random_gene_rank(const ExpressionData& expression,
-                                               size_t disease_size) {
+// Below this many null exceedances the empirical p-value is too coarse and
+// the tail approximation takes over (Knijnenburg et al., 2009).
+static constexpr size_t kMinEmpiricalExceedances = 10;
+
+static vector<size_t> rank_shuffled_labels(const ExpressionData& expression,
+                                           size_t disease_size,
+                                           mt19937_64& gen) {
     size_t num_cols = expression.num_samples();
 
     if (disease_size >= num_cols) {
@@ -25,8 +34,6 @@ vector<size_t> generate_random_gene_rank(const ExpressionData& expression,
     vector<size_t> all_indices(num_cols);
     iota(all_indices.begin(), all_indices.end(), size_t{0});
 
-    random_device rd;
-    mt19937 gen(rd());
     ranges::shuffle(all_indices, gen);
 
     // Split into disease and healthy
@@ -36,59 +43,205 @@ vector<size_t> generate_random_gene_rank(const ExpressionData& expression,
     return compute_gene_rank(expression, disease_indices, healthy_indices);
 }
 
-vector<vector<double>> compute_null_distribution(
+vector<size_t> generate_random_gene_rank(const ExpressionData& expression,
+                                               size_t disease_size) {
+    random_device rd;
+    mt19937_64 gen(rd());
+    return rank_shuffled_labels(expression, disease_size, gen);
+}
+
+vector<size_t> generate_random_gene_rank(const ExpressionData& expression,
+                                         size_t disease_size,
+                                         uint64_t seed,
+                                         uint64_t permutation) {
+    seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                      static_cast<uint32_t>(permutation),
+                      static_cast<uint32_t>(permutation >> 32)};
+    mt19937_64 gen(sequence);
+    return rank_shuffled_labels(expression, disease_size, gen);
+}
+
+vector<double> compute_null_distribution(
     const ExpressionData& expression,
     span<const GeneSet> gene_sets,
     size_t disease_size,
     size_t sample_size) {
 
+    vector<double> distribution(sample_size * gene_sets.size());
+    compute_null_distribution(expression, gene_sets, disease_size, sample_size, distribution);
+    return distribution;
+}
+
+void compute_null_distribution(
+    const ExpressionData& expression,
+    span<const GeneSet> gene_sets,
+    size_t disease_size,
+    size_t sample_size,
+    span<double> null_distribution) {
+
+    size_t num_sets = gene_sets.size();
+    if (null_distribution.size() != sample_size * num_sets) {
+        throw invalid_argument("Null distribution buffer must hold sample_size * num_sets scores");
+    }
+
+    // Checked before the parallel loop, which cannot propagate exceptions
+    if (disease_size >= expression.num_samples()) {
+        throw invalid_argument("Disease size must be less than total number of samples");
+    }
+    if (num_sets == 0) return;
+    GeneSetIndex index(gene_sets);
+    if (index.num_genes() != expression.num_genes()) {
+        throw invalid_argument(format("Gene sets were resolved against {} genes, expression has {}",
+                                      index.num_genes(), expression.num_genes()));
+    }
+
     vector<size_t> indices(sample_size);
     iota(indices.begin(), indices.end(), size_t{0});
 
-    vector<vector<double>> distribution(sample_size);
-
 #ifdef USE_PARALLEL_STL
-    transform(execution::par_unseq,
-                   indices.begin(), indices.end(),
-                   distribution.begin(),
-                   [&](size_t) {
+    // Not par_unseq: each permutation allocates, and index scoring keeps
+    // per-thread scratch that interleaved iterations would share
+    for_each(execution::par, indices.begin(), indices.end(), [&](size_t sample) {
 #else
-    transform(indices.begin(), indices.end(), distribution.begin(), [&](size_t) {
+    for_each(indices.begin(), indices.end(), [&](size_t sample) {
 #endif
         auto random_rank = generate_random_gene_rank(expression, disease_size);
+        index.score_ranking(random_rank, null_distribution.subspan(sample * num_sets, num_sets));
+    });
+}
+
+vector<PValueEstimate> estimate_p_values(
+    span<const double> actual_scores,
+    span<const double> null_distribution,
+    size_t num_sets,
+    bool tail_approximation) {
+
+    if (num_sets == 0) {
+        return {};
+    }
+
+    size_t sample_size = null_distribution.size() / num_sets;
+    vector<PValueEstimate> estimates(num_sets);
+
+    auto estimate = [&](size_t i) {
+        double actual_score = actual_scores[i];
 
-        vector<double> scores;
-        scores.reserve(gene_sets.size());
-        for (const auto& gene_set : gene_sets) {
-            scores.push_back(calculate_enrichment_score(gene_set, random_rank));
+        size_t count_greater = 0;
+        for (size_t sample = 0; sample < sample_size; ++sample) {
+            if (null_distribution[sample * num_sets + i] >= actual_score) {
+                ++count_greater;
+            }
         }
-        return scores;
-    });
 
-    return distribution;
+        double empirical_p;
+        empirical_p = static_cast<double>(count_greater) / sample_size;
+        estimates[i] = {empirical_p, count_greater, nullopt};
+
+        if (!tail_approximation || count_greater >= kMinEmpiricalExceedances) {
+            return;
+        }
+
+        vector<double> set_null(sample_size);
+        for (size_t sample = 0; sample < sample_size; ++sample) {
+            set_null[sample] = null_distribution[sample * num_sets + i];
+        }
+
+        auto fit = fit_pareto_tail(set_null);
+        if (fit && actual_score > fit->threshold) {
+            double tail_p = pareto_tail_p_value(*fit, actual_score);
+            estimates[i].tail = fit;
+            if (tail_p > 0.0) {
+                estimates[i].p_value = tail_p;
+                estimates[i].method = PValueMethod::Pareto;
+            } else {
+                estimates[i].p_value = (count_greater + 1.0) / (sample_size + 1.0);
+                estimates[i].method = PValueMethod::Bound;
+            }
+        }
+    };
+
+    vector<size_t> indices(num_sets);
+    iota(indices.begin(), indices.end(), size_t{0});
+#ifdef USE_PARALLEL_STL
+    for_each(execution::par, indices.begin(), indices.end(), estimate);
+#else
+    for_each(indices.begin(), indices.end(), estimate);
+#endif
+
+    return estimates;
+}
+
+// Acklam's rational approximation, refined by one Halley step to full
+// double precision
+double normal_quantile(double p) {
+    static constexpr double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                                   -2.759285104469687e+02, 1.383577518672690e+02,
+                                   -3.066479806614716e+01, 2.506628277459239e+00};
+    static constexpr double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                                   -1.556989798598866e+02, 6.680131188771972e+01,
+                                   -1.328068155288572e+01};
+    static constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                                   -2.400758277161838e+00, -2.549732539343734e+00,
+                                   4.374664141464968e+00, 2.938163982698783e+00};
+    static constexpr double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                                   2.445134137142996e+00, 3.754408661907416e+00};
+    static constexpr double p_low = 0.02425;
+
+    double x;
+    if (p < p_low) {
+        double q = sqrt(-2.0 * log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    } else if (p <= 1.0 - p_low) {
+        double q = p - 0.5;
+        double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    } else {
+        double q = sqrt(-2.0 * log1p(-p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+
+    double e = 0.5 * erfc(-x / numbers::sqrt2) - p;
+    double u = e * sqrt(2.0 * numbers::pi) * exp(x * x / 2.0);
+    return x - u / (1.0 + x * u / 2.0);
+}
+
+ConfidenceInterval wilson_interval(size_t count, size_t n, double confidence) {
+    if (n == 0) {
+        return {0.0, 1.0};
+    }
+
+    double z = normal_quantile(0.5 + confidence / 2.0);
+    double z2 = z * z;
+    double p = static_cast<double>(count) / n;
+    double denominator = 1.0 + z2 / n;
+    double center = (p + z2 / (2.0 * n)) / denominator;
+    double half_width = z * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denominator;
+    return {max(0.0, center - half_width), min(1.0, center + half_width)};
 }
 
 vector<size_t> find_significant_sets(
     span<const double> actual_scores,
-    span<const vector<double>> null_distribution,
+    span<const double> null_distribution,
     double p_value,
-    size_t num_sets) {
+    size_t num_sets,
+    bool tail_approximation) {
+
+    if (num_sets == 0) {
+        return {};
+    }
 
-    size_t sample_size = null_distribution.size();
     double corrected_p;
     corrected_p = p_value / num_sets;
 
-    vector<size_t> significant;
+    auto estimates = estimate_p_values(
+        actual_scores, null_distribution, num_sets, tail_approximation);
 
+    vector<size_t> significant;
     for (size_t i = 0; i < num_sets; ++i) {
-        double actual_score = actual_scores[i];
-
-        size_t count_greater = ranges::count_if(null_distribution,
-            [&](const auto& sample) { return sample[i] >= actual_score; });
-
-        double empirical_p;
-        empirical_p = static_cast<double>(count_greater) / sample_size;
-        if (empirical_p < corrected_p) {
+        if (estimates[i].p_value < corrected_p) {
             significant.push_back(i);
         }
     }
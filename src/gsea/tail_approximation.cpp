@@ -0,0 +1,167 @@
+#include "gsea/tail_approximation.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace gsea {
+
+static constexpr size_t kMaxExceedances = 250;
+static constexpr size_t kMinExceedances = 10;
+static constexpr size_t kExceedanceStep = 10;
+static constexpr size_t kBootstrapSamples = 200;
+static constexpr double kFitAlpha = 0.05;
+
+struct ParetoParams {
+    double shape;
+    double scale;
+};
+
+// Survival function P(Y > y), computed directly so tiny tails keep precision.
+static double pareto_survival(const ParetoParams& params, double y) {
+    if (abs(params.shape) < 1e-12) {
+        return exp(-y / params.scale);
+    }
+    double base = 1.0 + params.shape * y / params.scale;
+    if (base <= 0.0) {
+        return 0.0;
+    }
+    return pow(base, -1.0 / params.shape);
+}
+
+// Zhang & Stephens (2009) quasi-Bayesian estimator over a grid of
+// b = -shape / scale; x must be sorted ascending and non-negative.
+static optional<ParetoParams> fit_pareto(span<const double> x) {
+    size_t n = x.size();
+    double x_max = x.back();
+    double x_star = x[static_cast<size_t>(n / 4.0 + 0.5) - 1];
+    if (x_star <= 0.0 || x_max <= 0.0) {
+        return nullopt;
+    }
+
+    auto mean_log1p = [&](double b) {
+        double sum = 0.0;
+        for (double value : x) {
+            sum += log1p(-b * value);
+        }
+        return sum / n;
+    };
+
+    size_t m = 20 + static_cast<size_t>(sqrt(static_cast<double>(n)));
+    vector<double> grid(m);
+    vector<double> log_lik(m);
+    for (size_t j = 0; j < m; ++j) {
+        grid[j] = 1.0 / x_max + (1.0 - sqrt(m / (j + 0.5))) / (3.0 * x_star);
+        double k = mean_log1p(grid[j]);
+        log_lik[j] = n * (log(-grid[j] / k) - k - 1.0);
+    }
+
+    double b = 0.0;
+    double weight_sum = 0.0;
+    for (size_t j = 0; j < m; ++j) {
+        double denom = 0.0;
+        for (size_t l = 0; l < m; ++l) {
+            denom += exp(log_lik[l] - log_lik[j]);
+        }
+        double weight = 1.0 / denom;
+        b += weight * grid[j];
+        weight_sum += weight;
+    }
+    b /= weight_sum;
+
+    if (!isfinite(b)) {
+        return nullopt;
+    }
+    if (abs(b) < 1e-12) {
+        // Exponential limit
+        return ParetoParams{0.0, accumulate(x.begin(), x.end(), 0.0) / n};
+    }
+
+    double shape = mean_log1p(b);
+    double scale = -shape / b;
+    if (!isfinite(shape) || !(scale > 0.0)) {
+        return nullopt;
+    }
+    return ParetoParams{shape, scale};
+}
+
+static double anderson_darling(span<const double> x, const ParetoParams& params) {
+    constexpr double eps = 1e-12;
+    size_t n = x.size();
+
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double cdf = clamp(1.0 - pareto_survival(params, x[i]), eps, 1.0 - eps);
+        double survival = clamp(pareto_survival(params, x[n - 1 - i]), eps, 1.0 - eps);
+        sum += (2.0 * i + 1.0) * (log(cdf) + log(survival));
+    }
+    return -static_cast<double>(n) - sum / n;
+}
+
+// The null distribution of A^2 depends on the estimated shape, so it is
+// calibrated by refitting samples drawn from the fitted distribution.
+static double anderson_darling_p_value(double statistic, size_t n,
+                                       const ParetoParams& params) {
+    mt19937_64 gen(n);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    vector<double> sample(n);
+
+    size_t count_greater = 0;
+    for (size_t rep = 0; rep < kBootstrapSamples; ++rep) {
+        for (auto& value : sample) {
+            double u = uniform(gen);
+            value = abs(params.shape) < 1e-12
+                ? -params.scale * log1p(-u)
+                : params.scale * (pow(1.0 - u, -params.shape) - 1.0) / params.shape;
+        }
+        ranges::sort(sample);
+
+        auto refit = fit_pareto(sample);
+        if (!refit || anderson_darling(sample, *refit) >= statistic) {
+            ++count_greater;
+        }
+    }
+
+    return (count_greater + 1.0) / (kBootstrapSamples + 1.0);
+}
+
+optional<TailFit> fit_pareto_tail(span<const double> null_scores) {
+    size_t n = null_scores.size();
+    vector<double> sorted(null_scores.begin(), null_scores.end());
+    ranges::sort(sorted, ranges::greater{});
+
+    vector<double> exceedances;
+    for (size_t n_exc = min(kMaxExceedances, n / 4);
+         n_exc >= kMinExceedances;
+         n_exc -= kExceedanceStep) {
+        double threshold = (sorted[n_exc - 1] + sorted[n_exc]) / 2.0;
+
+        exceedances.resize(n_exc);
+        for (size_t i = 0; i < n_exc; ++i) {
+            exceedances[i] = sorted[n_exc - 1 - i] - threshold;
+        }
+
+        auto params = fit_pareto(exceedances);
+        if (!params) continue;
+
+        double statistic = anderson_darling(exceedances, *params);
+        double ad_p_value = anderson_darling_p_value(statistic, n_exc, *params);
+        if (ad_p_value >= kFitAlpha) {
+            return TailFit{threshold, params->shape, params->scale,
+                           n_exc, n, statistic, ad_p_value};
+        }
+    }
+
+    return nullopt;
+}
+
+double pareto_tail_p_value(const TailFit& fit, double score) {
+    double tail = pareto_survival({fit.shape, fit.scale}, max(score - fit.threshold, 0.0));
+    return static_cast<double>(fit.exceedances) / fit.null_size * tail;
+}
+
+} // namespace gsea
\ No newline at end of file
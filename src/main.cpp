@@ -1,26 +1,471 @@
 #include "gsea/analyzer.h"
+#include "gsea/ssgsea.h"
+#include "gsea/overlap.h"
+#include "gsea/enrichment.h"
+#include "gsea/group_statistics.h"
+#include "gsea/meta_analysis.h"
+#include "gsea/correlation.h"
+#include "gsea/statistics.h"
+#include "data_loader/expression_loader.h"
+#include "data_loader/sample_loader.h"
+#include "data_loader/geneset_loader.h"
+#include "data_loader/score_matrix_writer.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <vector>
 #include <format>
 #include <ranges>
+#include <string_view>
+#include <future>
+#include <optional>
+#include <chrono>
 
 using namespace std;
 using namespace gsea;
 
-int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        cerr << format("Usage: {} <expression_file> <sample_file> <geneset_file>\n", argv[0]);
-        cerr << "Please specify an expression file, sample file, and gene set file.\n";
+struct Options {
+    string command;
+    vector<string> inputs;
+    size_t permutations = 100;
+    bool tail_approximation = false;
+    bool numa = false;
+    GeneSetFilter filter;
+    string output_prefix;
+    double alpha = 0.25;
+    optional<double> collapse_threshold;
+    OverlapMetric metric = OverlapMetric::Jaccard;
+    string permutation_store;
+    uint64_t seed = 0;
+    string statistics_file;
+    MetaMethod meta_method = MetaMethod::Stouffer;
+    optional<double> time_budget;
+    CorrelationMethod correlation = CorrelationMethod::Pearson;
+};
+
+static void print_usage(const char* program) {
+    cerr << format("Usage: {} <expression_file> <sample_file> <geneset_file> [options]\n", program);
+    cerr << format("       {} ssgsea <expression_file> <geneset_file> [options]\n", program);
+    cerr << format("       {} overlap <expression_file> <geneset_file> [options]\n", program);
+    cerr << format("       {} update <expression_file> <sample_file> <geneset_file> [options]\n", program);
+    cerr << format("       {} correlate <expression_file> <phenotype_file> <geneset_file> [options]\n",
+                   program);
+    cerr << format("       {} meta <geneset_file> <expression_file> <sample_file> "
+                   "[<expression_file> <sample_file> ...] [options]\n", program);
+    cerr << "Please specify an expression file, sample file, and gene set file.\n";
+    cerr << "The ssgsea command scores every gene set in every sample instead;\n";
+    cerr << "the overlap command writes the pairwise gene set similarity matrix;\n";
+    cerr << "the update command refreshes enrichment scores from cached group\n";
+    cerr << "sums, loading only samples added since the last update; the meta\n";
+    cerr << "command combines per-set results across several cohorts; the\n";
+    cerr << "correlate command ranks genes by correlation with a continuous\n";
+    cerr << "phenotype (sample<TAB>value).\n";
+    cerr << "Options:\n";
+    cerr << "  --permutations <n>  Number of label permutations (default 100)\n";
+    cerr << "  --time-budget <s>   Run permutations in batches for up to s seconds,\n";
+    cerr << "                      stopping once every significance call is settled\n";
+    cerr << "  --tail-approx       Fit a generalised Pareto tail when too few\n";
+    cerr << "                      permutations exceed the observed score\n";
+    cerr << "  --min-size <n>      Skip gene sets with fewer matched genes\n";
+    cerr << "  --max-size <n>      Skip gene sets with more matched genes; both\n";
+    cerr << "                      apply after matching, so every set selected by\n";
+    cerr << "                      name is still read\n";
+    cerr << "  --set-prefix <s>    Only load gene sets whose name starts with s\n";
+    cerr << "  --set-regex <re>    Only load gene sets whose name matches re\n";
+    cerr << "  --numa              Pin permutation workers per NUMA node and\n";
+    cerr << "                      replicate read-only data on each node\n";
+    cerr << "  --perm-store <dir>  Keep permutation rankings in dir and reuse them\n";
+    cerr << "                      across runs and gene set collections\n";
+    cerr << "  --seed <n>          Permutation seed for --perm-store (default 0)\n";
+    cerr << "  --collapse <t>      Drop gene sets at least t similar to a larger set\n";
+    cerr << "  --metric <m>        Similarity for --collapse and overlap: jaccard\n";
+    cerr << "                      (default) or overlap\n";
+    cerr << "  --out <prefix>      ssgsea/overlap/meta output prefix (default\n";
+    cerr << "                      ssgsea_scores / gene_set_overlap /\n";
+    cerr << "                      meta_analysis); writes <prefix>.tsv, and\n";
+    cerr << "                      <prefix>.bin for ssgsea and overlap\n";
+    cerr << "  --alpha <a>         ssgsea rank weight exponent (default 0.25)\n";
+    cerr << "  --stats <file>      update statistics cache (default\n";
+    cerr << "                      <expression_file>.stats)\n";
+    cerr << "  --correlation <m>   correlate method: pearson (default) or spearman\n";
+    cerr << "  --meta-method <m>   meta combination: stouffer (default), fisher\n";
+    cerr << "                      or nes (mean normalised enrichment score)\n";
+}
+
+static Options parse_options(int argc, char* argv[]) {
+    Options options;
+    int first = 1;
+    if (argc > 1 && (string_view(argv[1]) == "ssgsea" || string_view(argv[1]) == "overlap" ||
+                     string_view(argv[1]) == "update" || string_view(argv[1]) == "meta" ||
+                     string_view(argv[1]) == "correlate")) {
+        options.command = argv[1];
+        first = 2;
+    }
+
+    for (int i = first; i < argc; ++i) {
+        string_view arg = argv[i];
+        if (arg == "--permutations" && i + 1 < argc) {
+            options.permutations = stoul(argv[++i]);
+        } else if (arg == "--time-budget" && i + 1 < argc) {
+            options.time_budget = stod(argv[++i]);
+        } else if (arg == "--tail-approx") {
+            options.tail_approximation = true;
+        } else if (arg == "--min-size" && i + 1 < argc) {
+            options.filter.min_size = stoul(argv[++i]);
+        } else if (arg == "--max-size" && i + 1 < argc) {
+            options.filter.max_size = stoul(argv[++i]);
+        } else if (arg == "--set-prefix" && i + 1 < argc) {
+            options.filter.name_prefix = argv[++i];
+        } else if (arg == "--set-regex" && i + 1 < argc) {
+            options.filter.name_pattern = argv[++i];
+        } else if (arg == "--numa") {
+            options.numa = true;
+        } else if (arg == "--perm-store" && i + 1 < argc) {
+            options.permutation_store = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = stoull(argv[++i]);
+        } else if (arg == "--collapse" && i + 1 < argc) {
+            options.collapse_threshold = stod(argv[++i]);
+        } else if (arg == "--metric" && i + 1 < argc) {
+            string_view metric = argv[++i];
+            if (metric == "jaccard") {
+                options.metric = OverlapMetric::Jaccard;
+            } else if (metric == "overlap") {
+                options.metric = OverlapMetric::OverlapCoefficient;
+            } else {
+                throw invalid_argument(format("Unknown metric: {}", metric));
+            }
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.output_prefix = argv[++i];
+        } else if (arg == "--alpha" && i + 1 < argc) {
+            options.alpha = stod(argv[++i]);
+        } else if (arg == "--stats" && i + 1 < argc) {
+            options.statistics_file = argv[++i];
+        } else if (arg == "--correlation" && i + 1 < argc) {
+            string_view method = argv[++i];
+            if (method == "pearson") {
+                options.correlation = CorrelationMethod::Pearson;
+            } else if (method == "spearman") {
+                options.correlation = CorrelationMethod::Spearman;
+            } else {
+                throw invalid_argument(format("Unknown correlation method: {}", method));
+            }
+        } else if (arg == "--meta-method" && i + 1 < argc) {
+            string_view method = argv[++i];
+            if (method == "stouffer") {
+                options.meta_method = MetaMethod::Stouffer;
+            } else if (method == "fisher") {
+                options.meta_method = MetaMethod::Fisher;
+            } else if (method == "nes") {
+                options.meta_method = MetaMethod::MeanNES;
+            } else {
+                throw invalid_argument(format("Unknown meta-analysis method: {}", method));
+            }
+        } else if (arg.starts_with("--")) {
+            throw invalid_argument(format("Unknown option: {}", arg));
+        } else {
+            options.inputs.emplace_back(arg);
+        }
+    }
+    return options;
+}
+
+static int run_ssgsea(const Options& options) {
+    const auto& exp_file = options.inputs[0];
+    const auto& geneset_file = options.inputs[1];
+    string prefix = options.output_prefix.empty() ? "ssgsea_scores" : options.output_prefix;
+
+    try {
+        cout << "Loading data...\n";
+        auto records = async(launch::async, read_gene_set_records, geneset_file, options.filter);
+        auto expression = load_expression_data(exp_file);
+        cout << format("    Loaded {} genes across {} samples\n",
+                  expression.num_genes(), expression.num_samples());
+
+        auto gene_sets = resolve_gene_sets(records.get(), expression.gene_names(), options.filter);
+        cout << format("    Loaded {} gene sets\n", gene_sets.size());
+
+        cout << "Computing single-sample enrichment scores...\n";
+        auto scores = compute_ssgsea(expression, gene_sets, options.alpha);
+
+        vector<string> set_names;
+        set_names.reserve(gene_sets.size());
+        for (const auto& gene_set : gene_sets) {
+            set_names.emplace_back(gene_set.get_name());
+        }
+
+        write_score_matrix_tsv(prefix + ".tsv", scores, expression.sample_names(), set_names, "SAMPLE");
+        write_score_matrix_binary(prefix + ".bin", scores, expression.sample_names(), set_names);
+        cout << format("Wrote {}.tsv and {}.bin\n", prefix, prefix);
+
+    } catch (const exception& e) {
+        cerr << format("Error: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+static int run_overlap(const Options& options) {
+    const auto& exp_file = options.inputs[0];
+    const auto& geneset_file = options.inputs[1];
+    string prefix = options.output_prefix.empty() ? "gene_set_overlap" : options.output_prefix;
+
+    try {
+        cout << "Loading data...\n";
+        auto records = async(launch::async, read_gene_set_records, geneset_file, options.filter);
+        auto expression = load_expression_data(exp_file);
+        auto gene_sets = resolve_gene_sets(records.get(), expression.gene_names(), options.filter);
+        cout << format("    Loaded {} gene sets\n", gene_sets.size());
+
+        cout << "Computing pairwise gene set overlaps...\n";
+        auto similarity = compute_similarity(compute_intersections(gene_sets), options.metric);
+
+        vector<string> set_names;
+        set_names.reserve(gene_sets.size());
+        for (const auto& gene_set : gene_sets) {
+            set_names.emplace_back(gene_set.get_name());
+        }
+
+        write_score_matrix_tsv(prefix + ".tsv", similarity, set_names, set_names, "GENE_SET");
+        write_score_matrix_binary(prefix + ".bin", similarity, set_names, set_names);
+        cout << format("Wrote {}.tsv and {}.bin\n", prefix, prefix);
+
+        auto representative = find_identical_sets(gene_sets);
+        cout << "Gene sets identical after matching expression genes:\n";
+        for (size_t i = 0; i < gene_sets.size(); ++i) {
+            if (representative[i] != i) {
+                cout << format("{}\t{}\n", set_names[i], set_names[representative[i]]);
+            }
+        }
+
+    } catch (const exception& e) {
+        cerr << format("Error: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+static int run_update(const Options& options) {
+    const auto& exp_file = options.inputs[0];
+    const auto& samp_file = options.inputs[1];
+    const auto& geneset_file = options.inputs[2];
+    string statistics_file = options.statistics_file.empty()
+        ? exp_file + ".stats" : options.statistics_file;
+
+    try {
+        cout << "Loading data...\n";
+        auto records = async(launch::async, read_gene_set_records, geneset_file, options.filter);
+        auto samples = load_sample_data(samp_file);
+
+        // Reuse the cache unless accumulated samples were dropped, relabelled
+        // or changed values
+        auto statistics = load_group_statistics(statistics_file);
+        if (statistics && !labels_unchanged(*statistics, samples)) {
+            cout << "  Sample labels changed, rebuilding statistics\n";
+            statistics.reset();
+        }
+
+        ColumnFingerprints fingerprints;
+        span<const string> cached_samples;
+        if (statistics) {
+            cached_samples = statistics->sample_names;
+        }
+        auto expression = load_expression_data(exp_file, cached_samples, fingerprints);
+        if (statistics && !ranges::equal(statistics->gene_names, expression.gene_names())) {
+            cout << "  Expression genes changed, rebuilding statistics\n";
+            statistics.reset();
+            expression = load_expression_data(exp_file, {}, fingerprints);
+        } else if (statistics && !columns_unchanged(*statistics, fingerprints.skipped)) {
+            cout << "  Cached samples were removed or changed, rebuilding statistics\n";
+            statistics.reset();
+            expression = load_expression_data(exp_file, {}, fingerprints);
+        }
+        if (!statistics) {
+            statistics = make_group_statistics(expression.gene_names());
+        }
+
+        size_t cached = statistics->sample_names.size();
+        size_t added = accumulate_samples(*statistics, expression, samples, fingerprints.loaded);
+        cout << format("    {} cached samples, {} added\n", cached, added);
+        if (added > 0) {
+            save_group_statistics(statistics_file, *statistics);
+        }
+
+        auto gene_sets = resolve_gene_sets(records.get(), statistics->gene_names, options.filter);
+        cout << format("    Loaded {} gene sets\n", gene_sets.size());
+
+        cout << "Computing enrichment scores...\n";
+        auto gene_rank = compute_gene_rank(*statistics, true);
+        vector<double> scores(gene_sets.size());
+        score_gene_sets(gene_sets, gene_rank, scores);
+
+        vector<pair<string, double>> sorted_scores;
+        sorted_scores.reserve(gene_sets.size());
+        for (size_t i = 0; i < gene_sets.size(); ++i) {
+            sorted_scores.emplace_back(gene_sets[i].get_name(), scores[i]);
+        }
+        ranges::sort(sorted_scores, ranges::greater{}, &pair<string, double>::second);
+
+        ofstream file("kegg_enrichment_scores.txt");
+        if (!file) {
+            throw runtime_error("Failed to create output file");
+        }
+
+        for (const auto& [name, score] : sorted_scores) {
+            file << format("{}\t{}\n", name, score);
+        }
+
+    } catch (const exception& e) {
+        cerr << format("Error: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+static int run_correlate(const Options& options) {
+    const auto& exp_file = options.inputs[0];
+    const auto& phenotype_file = options.inputs[1];
+    const auto& geneset_file = options.inputs[2];
+    string prefix = options.output_prefix.empty() ? "correlation_enrichment" : options.output_prefix;
+
+    try {
+        cout << "Loading data...\n";
+        auto records = async(launch::async, read_gene_set_records, geneset_file, options.filter);
+        auto phenotype = async(launch::async, load_continuous_phenotype, phenotype_file);
+        auto expression = load_expression_data(exp_file);
+        cout << format("    Loaded {} genes across {} samples\n",
+                  expression.num_genes(), expression.num_samples());
+
+        auto gene_sets = resolve_gene_sets(records.get(), expression.gene_names(), options.filter);
+        cout << format("    Loaded {} gene sets\n", gene_sets.size());
+
+        auto model = make_correlation_model(expression, phenotype.get(), options.correlation);
+        cout << format("    Correlating over {} phenotyped samples\n", model.phenotype.size());
+
+        cout << "Computing enrichment scores...\n";
+        auto gene_rank = compute_correlation_rank(model, true);
+        vector<double> scores(gene_sets.size());
+        score_gene_sets(gene_sets, gene_rank, scores);
+
+        cout << format("  Generating null distribution with {} permutations...\n",
+                  options.permutations);
+        vector<double> null_distribution(options.permutations * gene_sets.size());
+        compute_correlation_null_distribution(model, gene_sets, options.permutations,
+                                              null_distribution);
+        auto estimates = estimate_p_values(scores, null_distribution, gene_sets.size(),
+                                           options.tail_approximation);
+
+        ofstream file(prefix + ".tsv");
+        if (!file) {
+            throw runtime_error("Failed to create correlation output file");
+        }
+
+        file << "gene_set\tscore\tp_value\n";
+        for (size_t i = 0; i < gene_sets.size(); ++i) {
+            file << format("{}\t{}\t{}\n",
+                gene_sets[i].get_name(), scores[i], estimates[i].p_value);
+        }
+        cout << format("Wrote {}.tsv\n", prefix);
+
+        double corrected_p = 0.05 / gene_sets.size();
+        cout << "Significant gene sets:\n";
+        for (size_t i = 0; i < gene_sets.size(); ++i) {
+            if (estimates[i].p_value < corrected_p) {
+                cout << gene_sets[i].get_name() << '\n';
+            }
+        }
+
+    } catch (const exception& e) {
+        cerr << format("Error: {}\n", e.what());
         return 1;
     }
 
-    const auto [exp_file, samp_file, kegg_file] = tuple{argv[1], argv[2], argv[3]};
+    return 0;
+}
+
+static int run_meta(const Options& options) {
+    const auto& geneset_file = options.inputs[0];
+    string prefix = options.output_prefix.empty() ? "meta_analysis" : options.output_prefix;
 
     try {
         cout << "Loading data...\n";
-        GSEAAnalyzer analyzer(exp_file, samp_file, kegg_file);
+        auto records = async(launch::async, read_gene_set_records, geneset_file, options.filter);
+
+        vector<future<ExpressionData>> expressions;
+        vector<future<SampleData>> samples;
+        for (size_t i = 1; i + 1 < options.inputs.size(); i += 2) {
+            expressions.push_back(async(launch::async, [&options, i] {
+                return load_expression_data(options.inputs[i]);
+            }));
+            samples.push_back(async(launch::async, load_sample_data, options.inputs[i + 1]));
+        }
+
+        vector<Cohort> cohorts;
+        for (size_t c = 0; c < expressions.size(); ++c) {
+            cohorts.push_back({expressions[c].get(), samples[c].get()});
+            cout << format("    Cohort {}: {} genes, {} samples ({} diseased, {} healthy)\n",
+                      c + 1, cohorts[c].expression.num_genes(), cohorts[c].expression.num_samples(),
+                      cohorts[c].samples.num_diseased(), cohorts[c].samples.num_healthy());
+        }
+
+        auto gene_sets = resolve_cohort_gene_sets(records.get(), cohorts, options.filter);
+        cout << format("    Loaded {} gene sets over {} genes\n",
+                  gene_sets.union_sets.size(), gene_sets.union_genes.size());
+
+        cout << format("Running {} cohorts with {} permutations...\n",
+                  cohorts.size(), options.permutations);
+        auto results = run_meta_analysis(cohorts, gene_sets, options.permutations,
+                                         options.meta_method, options.tail_approximation);
+
+        ofstream file(prefix + ".tsv");
+        if (!file) {
+            throw runtime_error("Failed to create meta-analysis output file");
+        }
+
+        file << "gene_set\tcohorts\tstatistic\tp_value\n";
+        for (const auto& result : results) {
+            file << format("{}\t{}\t{}\t{}\n",
+                result.name, result.num_cohorts, result.statistic, result.p_value);
+        }
+        cout << format("Wrote {}.tsv\n", prefix);
+
+        double corrected_p = 0.05 / results.size();
+        cout << "Significant gene sets:\n";
+        for (const auto& result : results) {
+            if (result.p_value < corrected_p) {
+                cout << result.name << '\n';
+            }
+        }
+
+    } catch (const exception& e) {
+        cerr << format("Error: {}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+static int run_gsea(const Options& options) {
+    const auto& exp_file = options.inputs[0];
+    const auto& samp_file = options.inputs[1];
+    const auto& kegg_file = options.inputs[2];
+
+    try {
+        cout << "Loading data...\n";
+        GSEAAnalyzer analyzer(exp_file, samp_file, kegg_file, options.filter);
+        analyzer.set_numa(options.numa);
+        if (!options.permutation_store.empty()) {
+            analyzer.set_permutation_store(options.permutation_store, options.seed);
+        }
+
+        if (options.collapse_threshold) {
+            size_t removed = analyzer.collapse_redundant_sets(*options.collapse_threshold,
+                                                              options.metric);
+            cout << format("  Collapsed {} redundant gene sets\n", removed);
+        }
 
         cout << "Computing enrichment scores...\n";
         auto es_scores = analyzer.compute_all_enrichment_scores();
@@ -43,11 +488,59 @@ int main(int argc, char* argv[]) {
         }
 
         cout << "Computing statistically significant gene sets...\n";
-        auto sig_sets = analyzer.get_significant_sets(0.05, 100);
+        if (options.time_budget) {
+            auto budget = chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(*options.time_budget));
+            auto progress = analyzer.get_significant_sets_anytime(0.05, budget,
+                [](const SignificanceProgress& snapshot) {
+                    cout << format("  {} permutations in {:.1f}s: {} of {} sets decided\n",
+                        snapshot.permutations,
+                        chrono::duration<double>(snapshot.elapsed).count(),
+                        snapshot.num_decided, snapshot.decided.size());
+                    return true;
+                });
+
+            cout << "Significant gene sets:\n";
+            for (size_t i = 0; i < progress.estimates.size(); ++i) {
+                if (progress.significant[i]) {
+                    cout << analyzer.gene_sets()[i].get_name()
+                         << (progress.decided[i] ? "" : "\t(undecided)") << '\n';
+                }
+            }
+            return 0;
+        }
+
+        auto p_values = analyzer.get_p_values(options.permutations, options.tail_approximation);
+        double corrected_p = 0.05 / analyzer.num_gene_sets();
+
+        if (options.tail_approximation) {
+            ofstream p_file("kegg_p_values.txt");
+            if (!p_file) {
+                throw runtime_error("Failed to create p-value output file");
+            }
+
+            p_file << "gene_set\tp_value\tmethod\texceedances\tshape\tscale\tad_p_value\n";
+            for (size_t i = 0; i < p_values.size(); ++i) {
+                const auto& estimate = p_values[i];
+                auto name = analyzer.gene_sets()[i].get_name();
+                if (estimate.tail) {
+                    p_file << format("{}\t{}\t{}\t{}\t{}\t{}\t{}\n",
+                        name, estimate.p_value,
+                        estimate.method == PValueMethod::Pareto ? "pareto" : "bound",
+                        estimate.tail->exceedances,
+                        estimate.tail->shape, estimate.tail->scale, estimate.tail->ad_p_value);
+                } else {
+                    p_file << format("{}\t{}\tempirical\t{}\t\t\t\n",
+                        name, estimate.p_value, estimate.count_greater);
+                }
+            }
+        }
 
         cout << "Significant gene sets:\n";
-        for (const auto& set_name : sig_sets) {
-            cout << set_name << '\n';
+        for (size_t i = 0; i < p_values.size(); ++i) {
+            if (p_values[i].p_value < corrected_p) {
+                cout << analyzer.gene_sets()[i].get_name() << '\n';
+            }
         }
 
     } catch (const exception& e) {
@@ -56,4 +549,45 @@ int main(int argc, char* argv[]) {
     }
 
     return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const exception& e) {
+        cerr << format("Error: {}\n", e.what());
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (options.command == "meta") {
+        if (options.inputs.size() < 3 || options.inputs.size() % 2 == 0) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return run_meta(options);
+    }
+
+    if (options.command == "update" || options.command == "correlate") {
+        if (options.inputs.size() != 3) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return options.command == "update" ? run_update(options) : run_correlate(options);
+    }
+
+    if (!options.command.empty()) {
+        if (options.inputs.size() != 2) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return options.command == "ssgsea" ? run_ssgsea(options) : run_overlap(options);
+    }
+
+    if (options.inputs.size() != 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    return run_gsea(options);
 }
\ No newline at end of file
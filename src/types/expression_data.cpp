@@ -1,4 +1,5 @@
 #include "types/expression_data.h"
+#include <stdexcept>
 
 using namespace std;
 
@@ -7,9 +8,54 @@ namespace gsea {
 ExpressionData::ExpressionData(Eigen::MatrixXd values,
                                vector<string> gene_names,
                                vector<string> sample_names)
-    : values_(std::move(values))
-    , gene_names_(std::move(gene_names))
-    , sample_names_(std::move(sample_names)) {}
+    : owned_values_(std::move(values))
+    , owned_gene_names_(std::move(gene_names))
+    , owned_sample_names_(std::move(sample_names)) {
+    bind_owned();
+}
+
+ExpressionData::ExpressionData(MatrixView values,
+                               span<const string> gene_names,
+                               span<const string> sample_names)
+    : data_(values.data())
+    , stride_(values.outerStride())
+    , gene_names_(gene_names)
+    , sample_names_(sample_names) {
+    if (static_cast<size_t>(values.rows()) != gene_names.size() ||
+        static_cast<size_t>(values.cols()) != sample_names.size()) {
+        throw invalid_argument(
+            "Expression matrix shape must match gene and sample name counts");
+    }
+}
+
+ExpressionData::ExpressionData(const ExpressionData& other)
+    : owned_values_(other.owned_values_)
+    , owned_gene_names_(other.owned_gene_names_)
+    , owned_sample_names_(other.owned_sample_names_)
+    , owning_(other.owning_)
+    , data_(other.data_)
+    , stride_(other.stride_)
+    , gene_names_(other.gene_names_)
+    , sample_names_(other.sample_names_) {
+    if (owning_) {
+        bind_owned();
+    }
+}
+
+ExpressionData& ExpressionData::operator=(const ExpressionData& other) {
+    if (this != &other) {
+        *this = ExpressionData(other);
+    }
+    return *this;
+}
+
+void ExpressionData::bind_owned() noexcept {
+    owning_ = true;
+    data_ = owned_values_.data();
+    stride_ = owned_values_.outerStride();
+    gene_names_ = owned_gene_names_;
+    sample_names_ = owned_sample_names_;
+}
 
 optional<string_view> ExpressionData::gene_name(size_t index) const noexcept {
     if (index < gene_names_.size()) {
@@ -27,7 +73,7 @@ optional<string_view> ExpressionData::sample_name(size_t index) const noexcept {
 
 optional<double> ExpressionData::get_value(size_t gene_idx, size_t sample_idx) const noexcept {
     if (gene_idx < num_genes() && sample_idx < num_samples()) {
-        return values_(gene_idx, sample_idx);
+        return values()(gene_idx, sample_idx);
     }
     return nullopt;
 }
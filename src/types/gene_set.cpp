@@ -1,17 +1,60 @@
 #include "types/gene_set.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 using namespace std;
 
 namespace gsea {
 
-GeneSet::GeneSet(string name, size_t gene_count, Eigen::VectorXd scores)
+static void check_members(span<const uint32_t> members, size_t num_genes) {
+    if (members.empty() || members.size() > num_genes) {
+        throw invalid_argument("Gene set must contain between 1 and num_genes members");
+    }
+    if (ranges::any_of(members, [&](uint32_t idx) { return idx >= num_genes; })) {
+        throw invalid_argument("Gene set member index out of range");
+    }
+}
+
+GeneSet::GeneSet(string name, vector<uint32_t> members, size_t num_genes)
+    : name_(std::move(name))
+    , owned_members_(std::move(members))
+    , owning_(true)
+    , members_(owned_members_)
+    , num_genes_(num_genes) {
+    check_members(members_, num_genes_);
+    up_score_ = sqrt(static_cast<double>(num_genes_ - size()) / size());
+    down_score_ = -1.0 / up_score_;
+}
+
+GeneSet::GeneSet(string name, span<const uint32_t> members, size_t num_genes)
     : name_(std::move(name))
-    , gene_count_(gene_count)
-    , scores_(std::move(scores)) {}
+    , members_(members)
+    , num_genes_(num_genes) {
+    check_members(members_, num_genes_);
+    up_score_ = sqrt(static_cast<double>(num_genes_ - size()) / size());
+    down_score_ = -1.0 / up_score_;
+}
+
+GeneSet::GeneSet(const GeneSet& other)
+    : name_(other.name_)
+    , owned_members_(other.owned_members_)
+    , owning_(other.owning_)
+    , members_(owning_ ? span<const uint32_t>(owned_members_) : other.members_)
+    , num_genes_(other.num_genes_)
+    , up_score_(other.up_score_)
+    , down_score_(other.down_score_) {}
+
+GeneSet& GeneSet::operator=(const GeneSet& other) {
+    if (this != &other) {
+        *this = GeneSet(other);
+    }
+    return *this;
+}
 
 optional<double> GeneSet::get_score(size_t gene_idx) const noexcept {
-    if (gene_idx < static_cast<size_t>(scores_.size())) {
-        return scores_(gene_idx);
+    if (gene_idx < num_genes_) {
+        return ranges::find(members_, gene_idx) != members_.end() ? up_score_ : down_score_;
     }
     return nullopt;
 }
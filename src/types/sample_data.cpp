@@ -9,14 +9,49 @@ namespace gsea {
 
 SampleData::SampleData(vector<string> sample_names,
                        vector<uint8_t> disease_status)
-    : sample_names_(std::move(sample_names))
-    , disease_status_(std::move(disease_status)) {
+    : owned_sample_names_(std::move(sample_names))
+    , owned_disease_status_(std::move(disease_status)) {
+    bind_owned();
     if (sample_names_.size() != disease_status_.size()) {
         throw invalid_argument(
             "Sample names and disease status must have the same length");
     }
 }
 
+SampleData::SampleData(span<const string> sample_names,
+                       span<const uint8_t> disease_status)
+    : sample_names_(sample_names)
+    , disease_status_(disease_status) {
+    if (sample_names_.size() != disease_status_.size()) {
+        throw invalid_argument(
+            "Sample names and disease status must have the same length");
+    }
+}
+
+SampleData::SampleData(const SampleData& other)
+    : owned_sample_names_(other.owned_sample_names_)
+    , owned_disease_status_(other.owned_disease_status_)
+    , owning_(other.owning_)
+    , sample_names_(other.sample_names_)
+    , disease_status_(other.disease_status_) {
+    if (owning_) {
+        bind_owned();
+    }
+}
+
+SampleData& SampleData::operator=(const SampleData& other) {
+    if (this != &other) {
+        *this = SampleData(other);
+    }
+    return *this;
+}
+
+void SampleData::bind_owned() noexcept {
+    owning_ = true;
+    sample_names_ = owned_sample_names_;
+    disease_status_ = owned_disease_status_;
+}
+
 size_t SampleData::num_diseased() const noexcept {
     return ranges::count(disease_status_, 1);
 }
@@ -0,0 +1,102 @@
+#include "gsea/analyzer.h"
+#include "test_support.h"
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+static vector<GeneSet> make_gene_sets(size_t num_genes) {
+    vector<GeneSet> gene_sets;
+    gene_sets.emplace_back("LOW", vector<uint32_t>{0, 1, 2, 3}, num_genes);
+    gene_sets.emplace_back("LOW_COPY", vector<uint32_t>{0, 1, 2, 3}, num_genes);
+    gene_sets.emplace_back("HIGH", vector<uint32_t>{16, 17, 18, 19}, num_genes);
+    return gene_sets;
+}
+
+int main() {
+    constexpr size_t num_genes = 20;
+    constexpr size_t num_samples = 8;
+    vector<double> values(num_genes * num_samples);
+    for (size_t s = 0; s < num_samples; ++s) {
+        for (size_t g = 0; g < num_genes; ++g) {
+            values[s * num_genes + g] = static_cast<double>((g * 7 + s * 3) % 23);
+        }
+    }
+    MatrixView matrix(values.data(), num_genes, num_samples, Eigen::OuterStride<>(num_genes));
+    vector<string> gene_names;
+    for (size_t g = 0; g < num_genes; ++g) {
+        gene_names.push_back(format("G{}", g));
+    }
+    vector<string> sample_names;
+    for (size_t s = 0; s < num_samples; ++s) {
+        sample_names.push_back(format("S{}", s));
+    }
+    vector<uint8_t> disease_status = {1, 1, 1, 1, 0, 0, 0, 0};
+
+    // A copy keeps scoring correctly after the original is gone
+    optional<GSEAAnalyzer> original;
+    original.emplace(matrix, gene_names, sample_names, disease_status,
+                     make_gene_sets(num_genes));
+    auto expected = original->compute_all_enrichment_scores();
+    GSEAAnalyzer copy = *original;
+    original.reset();
+    auto scores = copy.compute_all_enrichment_scores();
+    CHECK(scores == expected);
+    CHECK(scores.at("LOW") == scores.at("LOW_COPY"));
+    CHECK(copy.get_p_values(50).size() == 3);
+
+    // With no time budget only the probe batch runs
+    auto progress = copy.get_significant_sets_anytime(0.05, chrono::steady_clock::duration::zero());
+    size_t probe_size = max<size_t>(1, thread::hardware_concurrency());
+    CHECK(progress.permutations == min<size_t>(probe_size, 100));
+    CHECK(progress.estimates.size() == 3);
+
+    // LOW scores below every permutation (p = 1) and HIGH near p = 0.6, so at
+    // a corrected threshold of 0.1 every interval soon clears it
+    constexpr auto hour = chrono::hours(1);
+    auto settled = copy.get_significant_sets_anytime(0.3, hour, {}, 20, 0.99, 100'000);
+    CHECK(settled.num_decided == 3);
+    CHECK(settled.permutations < 100'000);
+    CHECK(ranges::none_of(settled.significant, [](uint8_t s) { return s != 0; }));
+
+    // A callback returning false ends the run after the batch it saw
+    size_t calls = 0;
+    auto stopped = copy.get_significant_sets_anytime(
+        0.05, hour, [&](const SignificanceProgress&) { return ++calls < 1; }, 20);
+    CHECK(calls == 1);
+    CHECK(stopped.permutations == min<size_t>(probe_size, 20));
+
+    // At near-certain confidence nothing is decided within 37 permutations
+    auto capped = copy.get_significant_sets_anytime(1.5, hour, {}, 10, 1.0 - 1e-12, 37);
+    CHECK(capped.permutations == 37);
+    CHECK(capped.num_decided < 3);
+
+    // Batches are planned to end by the deadline at the measured rate
+    using seconds = chrono::duration<double>;
+    CHECK(plan_anytime_batch(100, 8, 0, seconds(0.0), seconds(0.0)) == 8);
+    CHECK(plan_anytime_batch(5, 8, 0, seconds(0.0), seconds(1.0)) == 5);
+    CHECK(plan_anytime_batch(100, 8, 100, seconds(1.0), seconds(0.255)) == 25);
+    CHECK(plan_anytime_batch(100, 8, 100, seconds(1.0), seconds(0.005)) == 0);
+    CHECK(plan_anytime_batch(100, 8, 100, seconds(1.0), seconds(-1.0)) == 0);
+    CHECK(plan_anytime_batch(100, 8, 100, seconds(1.0), seconds(60.0)) == 100);
+    bool within_deadline = true;
+    for (size_t done : {1, 7, 100, 12'345}) {
+        for (double spent : {1e-6, 0.003, 0.5, 20.0}) {
+            for (double remaining : {1e-7, 1e-4, 0.01, 0.7, 9.0, 1e4}) {
+                size_t batch = plan_anytime_batch(250, 8, done, seconds(spent),
+                                                  seconds(remaining));
+                within_deadline = within_deadline && batch <= 250 &&
+                                  batch * (spent / done) <= remaining;
+            }
+        }
+    }
+    CHECK(within_deadline);
+
+    CHECK_THROWS(GSEAAnalyzer(matrix, gene_names, sample_names, disease_status, {}));
+
+    return report("analyzer");
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "gsea/correlation.h"
+#include "test_support.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+int main() {
+    constexpr size_t num_genes = 30;
+    constexpr size_t num_samples = 9;
+    Eigen::MatrixXd values(num_genes, num_samples);
+    vector<string> gene_names;
+    vector<string> sample_names;
+    ContinuousPhenotype phenotype;
+    for (size_t g = 0; g < num_genes; ++g) {
+        gene_names.push_back(format("G{}", g));
+        for (size_t s = 0; s < num_samples; ++s) {
+            values(g, s) = static_cast<double>((g * 7 + s * s * 3) % 19);
+        }
+    }
+    for (size_t s = 0; s < num_samples; ++s) {
+        sample_names.push_back(format("S{}", s));
+        phenotype.sample_names.push_back(format("S{}", s));
+        phenotype.values.push_back(static_cast<double>(s) * 0.5);
+    }
+    ExpressionData expression(std::move(values), std::move(gene_names), std::move(sample_names));
+    auto model = make_correlation_model(expression, phenotype, CorrelationMethod::Pearson);
+
+    vector<GeneSet> gene_sets;
+    gene_sets.emplace_back("A", vector<uint32_t>{0, 3, 6, 9}, num_genes);
+    gene_sets.emplace_back("B", vector<uint32_t>{10, 11, 12, 13, 14}, num_genes);
+
+    // Block sizes below the 16-permutation floor and above the permutation
+    // count both fill every slot
+    for (size_t block_size : {size_t{1}, size_t{5}, size_t{16}, size_t{128}}) {
+        size_t sample_size = 70;
+        vector<double> null_distribution(sample_size * gene_sets.size(),
+                                          numeric_limits<double>::quiet_NaN());
+        compute_correlation_null_distribution(model, gene_sets, sample_size, null_distribution,
+                                              block_size);
+        bool all_filled = true;
+        for (double score : null_distribution) {
+            all_filled = all_filled && isfinite(score);
+        }
+        CHECK(all_filled);
+    }
+
+    vector<double> null_distribution(10 * gene_sets.size());
+    CHECK_THROWS(compute_correlation_null_distribution(model, gene_sets, 10, null_distribution, 0));
+
+    // Sets resolved against another gene count are rejected before the
+    // parallel loop rather than terminating inside it
+    vector<GeneSet> mismatched_sets;
+    mismatched_sets.emplace_back("WIDE", vector<uint32_t>{0, 1, 2}, num_genes + 1);
+    vector<double> mismatched_null(10);
+    CHECK_THROWS(compute_correlation_null_distribution(model, mismatched_sets, 10,
+                                                       mismatched_null));
+
+    return report("correlation");
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "gsea/gene_set_index.h"
+#include "gsea/enrichment.h"
+#include "gsea/ranking.h"
+#include "gsea/statistics.h"
+#include "test_support.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+// Index scores must match scoring each set on its own, bit for bit
+static bool matches_direct_scores(span<const GeneSet> gene_sets, span<const size_t> gene_rank) {
+    vector<uint32_t> gene_position(gene_rank.size());
+    invert_gene_rank(gene_rank, gene_position);
+
+    GeneSetIndex index(gene_sets);
+    vector<double> from_positions(gene_sets.size());
+    vector<double> from_ranking(gene_sets.size());
+    index.score(gene_position, from_positions);
+    index.score_ranking(gene_rank, from_ranking);
+
+    bool equal = true;
+    for (size_t s = 0; s < gene_sets.size(); ++s) {
+        double direct = calculate_enrichment_score_at(gene_sets[s], gene_position);
+        equal = equal && from_positions[s] == direct && from_ranking[s] == direct;
+    }
+    return equal;
+}
+
+int main() {
+    constexpr size_t num_genes = 500;
+    mt19937 rng(11);
+
+    vector<size_t> gene_rank(num_genes);
+    iota(gene_rank.begin(), gene_rank.end(), size_t{0});
+    ranges::shuffle(gene_rank, rng);
+
+    // Borrowed members in arbitrary order, as embedders may pass them
+    vector<vector<uint32_t>> members(120);
+    for (auto& set_members : members) {
+        vector<uint32_t> genes(num_genes);
+        iota(genes.begin(), genes.end(), uint32_t{0});
+        ranges::shuffle(genes, rng);
+        set_members.assign(genes.begin(), genes.begin() + 3 + rng() % 60);
+    }
+    vector<GeneSet> many;
+    for (size_t s = 0; s < members.size(); ++s) {
+        many.emplace_back(format("SET{}", s), span<const uint32_t>(members[s]), num_genes);
+    }
+
+    // Large collection: hits come from one walk down the ranking
+    CHECK(matches_direct_scores(many, gene_rank));
+    // Small collection: hits are gathered and sorted per set
+    vector<GeneSet> few;
+    few.emplace_back("FEW", span<const uint32_t>(members[0]).first(3), num_genes);
+    CHECK(matches_direct_scores(few, gene_rank));
+
+    GeneSetIndex index(many);
+    vector<double> wrong_size(many.size() - 1);
+    CHECK_THROWS(index.score_ranking(gene_rank, wrong_size));
+
+    // No sets: any ranking scores nothing, so parallel permutation loops
+    // over an empty collection have nothing to throw
+    GeneSetIndex empty(span<const GeneSet>{});
+    vector<uint32_t> gene_position(num_genes);
+    invert_gene_rank(gene_rank, gene_position);
+    empty.score(gene_position, {});
+    empty.score_ranking(gene_rank, {});
+    CHECK_THROWS(empty.score_ranking(gene_rank, wrong_size));
+
+    auto expression = make_expression(num_genes, 6);
+    CHECK(compute_null_distribution(expression, {}, 3, 5).empty());
+
+    return report("gene_set_index");
+}
\ No newline at end of file
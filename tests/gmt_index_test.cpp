@@ -0,0 +1,119 @@
+#include "data_loader/gmt_index.h"
+#include "data_loader/geneset_loader.h"
+#include "test_support.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+static string read_text(const filesystem::path& path) {
+    ifstream in(path, ios::binary);
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+// Replaces the first occurrence of from with to, which has the same length
+static void patch_file(const filesystem::path& path, const string& from, const string& to) {
+    auto text = read_text(path);
+    text.replace(text.find(from), from.size(), to);
+    write_text(path, text);
+}
+
+static vector<string> entry_names(const vector<GmtIndexEntry>& entries) {
+    vector<string> names;
+    for (const auto& entry : entries) {
+        names.push_back(entry.name);
+    }
+    return names;
+}
+
+static vector<string> record_names(const vector<GeneSetRecord>& records) {
+    vector<string> names;
+    for (const auto& record : records) {
+        names.push_back(record.name);
+    }
+    return names;
+}
+
+int main() {
+    auto directory = scratch_directory("gmt_index");
+    auto gmt = directory / "sets.gmt";
+    auto idx = directory / "sets.gmt.idx";
+    write_text(gmt, "KEGG_A\tdesc\tG1\tG2\n"
+                    "\n"
+                    "KEGG_B\tdesc\tG2\tG3\tG4\n"
+                    "REACTOME_C\tdesc\tG1\n");
+
+    // Built on first load, with offsets of each line
+    auto built = load_gmt_index(gmt.string());
+    CHECK(filesystem::exists(idx));
+    CHECK((entry_names(built) == vector<string>{"KEGG_A", "KEGG_B", "REACTOME_C"}));
+    CHECK(built.size() == 3 && built[1].offset == 19 && built[1].line_num == 3);
+
+    // Reused on the next: a name edited in the cache comes back as is
+    patch_file(idx, "KEGG_B", "KEGG_Z");
+    CHECK(load_gmt_index(gmt.string())[1].name == "KEGG_Z");
+
+    // A wrong magic, or a truncated index, is rebuilt from the GMT
+    patch_file(idx, "GSEAGMT2", "GSEAGMT1");
+    CHECK(load_gmt_index(gmt.string())[1].name == "KEGG_B");
+    auto index_text = read_text(idx);
+    write_text(idx, index_text.substr(0, index_text.size() - 5));
+    CHECK(load_gmt_index(gmt.string()).size() == 3);
+    CHECK(read_text(idx) == index_text);
+
+    // A GMT whose size or modification time changed is re-indexed
+    patch_file(idx, "KEGG_B", "KEGG_Z");
+    auto text = read_text(gmt);
+    write_text(gmt, text + "KEGG_D\tdesc\tG5\n");
+    CHECK(load_gmt_index(gmt.string()).size() == 4);
+
+    patch_file(idx, "KEGG_B", "KEGG_Z");
+    auto modified = filesystem::last_write_time(gmt);
+    patch_file(gmt, "KEGG_A", "KEGG_Y");
+    filesystem::last_write_time(gmt, modified + chrono::seconds(10));
+    auto restamped = load_gmt_index(gmt.string());
+    CHECK(restamped[0].name == "KEGG_Y" && restamped[1].name == "KEGG_B");
+
+    // Name filters select through the index; no filter streams everything
+    GeneSetFilter prefix;
+    prefix.name_prefix = "KEGG_";
+    CHECK((record_names(read_gene_set_records(gmt.string(), prefix)) ==
+           vector<string>{"KEGG_Y", "KEGG_B", "KEGG_D"}));
+    GeneSetFilter pattern;
+    pattern.name_pattern = ".*_[CD]";
+    auto matched = read_gene_set_records(gmt.string(), pattern);
+    CHECK((record_names(matched) == vector<string>{"REACTOME_C", "KEGG_D"}));
+    CHECK(matched.size() == 2 && matched[0].line_num == 4 && matched[0].genes.size() == 1);
+    CHECK(read_gene_set_records(gmt.string()).size() == 4);
+
+    // Concurrent writers each use their own temporary: the published index
+    // is always complete and no temporary is left behind
+    bool all_complete = true;
+    for (size_t round = 0; round < 20; ++round) {
+        filesystem::remove(idx);
+        vector<thread> writers;
+        vector<size_t> sizes(4);
+        for (size_t w = 0; w < sizes.size(); ++w) {
+            writers.emplace_back([&, w] { sizes[w] = load_gmt_index(gmt.string()).size(); });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        all_complete = all_complete && ranges::all_of(sizes, [](size_t s) { return s == 4; });
+        all_complete = all_complete && load_gmt_index(gmt.string()).size() == 4;
+    }
+    CHECK(all_complete);
+    size_t leftovers = 0;
+    for (const auto& file : filesystem::directory_iterator(directory)) {
+        leftovers += file.path().extension() == ".tmp";
+    }
+    CHECK(leftovers == 0);
+
+    return report("gmt_index");
+}
@@ -0,0 +1,109 @@
+#include "gsea/group_statistics.h"
+#include "data_loader/expression_loader.h"
+#include "test_support.h"
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+static constexpr size_t kNumGenes = 5;
+static constexpr size_t kNumSamples = 12;
+
+static SampleData make_samples(size_t num_samples) {
+    vector<string> names;
+    vector<uint8_t> status;
+    for (size_t s = 0; s < num_samples; ++s) {
+        names.push_back(format("S{}", s));
+        status.push_back(s % 3 == 0 ? 1 : 0);
+    }
+    return {std::move(names), std::move(status)};
+}
+
+static string expression_text(size_t num_samples, double changed_value) {
+    string text = "SYMBOL";
+    for (size_t s = 0; s < num_samples; ++s) {
+        text += format("\tS{}", s);
+    }
+    for (size_t g = 0; g < kNumGenes; ++g) {
+        text += format("\nG{}", g);
+        for (size_t s = 0; s < num_samples; ++s) {
+            text += format("\t{}", g == 0 && s == 1 ? changed_value : expression_value(g, s));
+        }
+    }
+    return text + "\n";
+}
+
+// Stand-in fingerprints for in-memory columns
+static vector<uint64_t> column_ids(size_t num_samples) {
+    vector<uint64_t> ids(num_samples);
+    for (size_t s = 0; s < num_samples; ++s) {
+        ids[s] = 100 + s;
+    }
+    return ids;
+}
+
+int main() {
+    auto expression = make_expression(kNumGenes, kNumSamples);
+    auto samples = make_samples(kNumSamples);
+    auto ids = column_ids(kNumSamples);
+
+    // Appending many short-named samples in one call reallocates sample_names
+    // while earlier names are still being looked up
+    auto full = make_group_statistics(expression.gene_names());
+    CHECK(accumulate_samples(full, expression, samples, ids) == kNumSamples);
+    CHECK(accumulate_samples(full, expression, samples, ids) == 0);
+    CHECK(full.num_diseased == 4 && full.num_healthy == 8);
+    CHECK(full.fingerprints == ids);
+    CHECK_THROWS(accumulate_samples(full, expression, samples, column_ids(kNumSamples - 1)));
+
+    // Accumulating in two steps matches a single pass exactly
+    auto partial = make_group_statistics(expression.gene_names());
+    auto first = make_expression(kNumGenes, 5);
+    CHECK(accumulate_samples(partial, first, make_samples(5), column_ids(5)) == 5);
+    CHECK(accumulate_samples(partial, expression, samples, ids) == kNumSamples - 5);
+    CHECK(partial.disease_sum == full.disease_sum);
+    CHECK(partial.healthy_sum_sq == full.healthy_sum_sq);
+    CHECK(partial.fingerprints == full.fingerprints);
+
+    auto directory = scratch_directory("group_statistics");
+    auto stats_path = (directory / "expr.stats").string();
+    save_group_statistics(stats_path, full);
+    auto loaded = load_group_statistics(stats_path);
+    CHECK(loaded && loaded->fingerprints == full.fingerprints);
+    CHECK(loaded && loaded->sample_names == full.sample_names);
+
+    // Statistics accumulated from the file record each column's text hash
+    auto expr_path = (directory / "expr.tsv").string();
+    ColumnFingerprints fingerprints;
+    write_text(expr_path, expression_text(kNumSamples, expression_value(0, 1)));
+    auto from_file = load_expression_data(expr_path, {}, fingerprints);
+    auto cached = make_group_statistics(from_file.gene_names());
+    CHECK(accumulate_samples(cached, from_file, samples, fingerprints.loaded) == kNumSamples);
+    CHECK(cached.disease_sum == full.disease_sum);
+
+    // Unchanged cached columns match without being loaded
+    auto rest = load_expression_data(expr_path, cached.sample_names, fingerprints);
+    CHECK(rest.num_samples() == 0);
+    CHECK(columns_unchanged(cached, fingerprints.skipped));
+
+    // Editing a cached column makes the cache stale; skipped columns are
+    // hashed, not parsed, so even unparsable text is only reported as a change
+    write_text(expr_path, expression_text(kNumSamples, 99.5));
+    (void)load_expression_data(expr_path, cached.sample_names, fingerprints);
+    CHECK(!columns_unchanged(cached, fingerprints.skipped));
+
+    auto garbled = expression_text(kNumSamples, expression_value(0, 1));
+    garbled.replace(garbled.find("\nG0\t") + 4, 1, "x");
+    write_text(expr_path, garbled);
+    (void)load_expression_data(expr_path, cached.sample_names, fingerprints);
+    CHECK(!columns_unchanged(cached, fingerprints.skipped));
+
+    // As does dropping one
+    write_text(expr_path, expression_text(kNumSamples - 1, expression_value(0, 1)));
+    (void)load_expression_data(expr_path, cached.sample_names, fingerprints);
+    CHECK(!fingerprints.skipped.back().has_value());
+    CHECK(!columns_unchanged(cached, fingerprints.skipped));
+
+    return report("group_statistics");
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "data_loader/input_stream.h"
+#include "data_loader/expression_loader.h"
+#include "test_support.h"
+#include <zlib.h>
+#include <vector>
+
+#ifdef GSEA_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+static string expression_text(size_t num_genes, size_t num_samples) {
+    string text = "SYMBOL";
+    for (size_t s = 0; s < num_samples; ++s) {
+        text += format("\tS{}", s);
+    }
+    text += '\n';
+    for (size_t g = 0; g < num_genes; ++g) {
+        text += format("G{}", g);
+        for (size_t s = 0; s < num_samples; ++s) {
+            text += format("\t{:.4f}", static_cast<double>((g * 31 + s * 17) % 97) / 7.0);
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+static string gzip(const string& text) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    string out(deflateBound(&stream, text.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = static_cast<uInt>(text.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+static size_t count_lines(const filesystem::path& path) {
+    InputStream stream(path.string());
+    string line;
+    size_t lines = 0;
+    while (getline(stream, line)) {
+        ++lines;
+    }
+    return lines;
+}
+
+static void check_truncation(const filesystem::path& directory,
+                             const string& name,
+                             const string& compressed) {
+    auto complete = directory / name;
+    write_text(complete, compressed);
+    CHECK(count_lines(complete) == 501);
+    CHECK(load_expression_data(complete.string()).num_genes() == 500);
+
+    // Cut inside the stream and just before its end
+    for (size_t keep : {compressed.size() / 2, compressed.size() - 1}) {
+        auto truncated = directory / format("truncated_{}_{}", keep, name);
+        write_text(truncated, compressed.substr(0, keep));
+        CHECK_THROWS(count_lines(truncated));
+        CHECK_THROWS(load_expression_data(truncated.string()));
+    }
+}
+
+int main() {
+    auto directory = scratch_directory("input_stream");
+    auto text = expression_text(500, 20);
+
+    write_text(directory / "expr.tsv", text);
+    CHECK(count_lines(directory / "expr.tsv") == 501);
+
+    auto compressed = gzip(text);
+    check_truncation(directory, "expr.tsv.gz", compressed);
+
+    // Concatenated members still decode as one stream
+    auto split = text.find('\n', text.size() / 2) + 1;
+    write_text(directory / "members.tsv.gz", gzip(text.substr(0, split)) + gzip(text.substr(split)));
+    CHECK(count_lines(directory / "members.tsv.gz") == 501);
+
+#ifdef GSEA_HAVE_ZSTD
+    string frame(ZSTD_compressBound(text.size()), '\0');
+    frame.resize(ZSTD_compress(frame.data(), frame.size(), text.data(), text.size(), 3));
+    check_truncation(directory, "expr.tsv.zst", frame);
+#endif
+
+    return report("input_stream");
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "gsea/meta_analysis.h"
+#include "test_support.h"
+#include <cmath>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+static Cohort make_cohort(size_t num_genes, size_t num_samples, const string& prefix) {
+    Eigen::MatrixXd values(num_genes, num_samples);
+    vector<string> gene_names;
+    vector<string> sample_names;
+    vector<uint8_t> status;
+    for (size_t g = 0; g < num_genes; ++g) {
+        gene_names.push_back(format("G{}", g));
+        for (size_t s = 0; s < num_samples; ++s) {
+            values(g, s) = static_cast<double>((g * 17 + s * 5) % 31) / 3.0;
+        }
+    }
+    for (size_t s = 0; s < num_samples; ++s) {
+        sample_names.push_back(format("{}{}", prefix, s));
+        status.push_back(s < num_samples / 2 ? 1 : 0);
+    }
+    return {ExpressionData(std::move(values), std::move(gene_names), vector<string>(sample_names)),
+            SampleData(std::move(sample_names), std::move(status))};
+}
+
+static CohortGeneSets make_gene_sets(span<const size_t> num_genes) {
+    CohortGeneSets gene_sets;
+    gene_sets.union_sets.emplace_back("SET", vector<uint32_t>{0, 1, 2, 3}, num_genes.front());
+    for (size_t genes : num_genes) {
+        gene_sets.cohort_sets.emplace_back();
+        gene_sets.cohort_sets.back().emplace_back("SET", vector<uint32_t>{0, 1, 2, 3}, genes);
+        gene_sets.cohort_set_index.push_back({0});
+    }
+    return gene_sets;
+}
+
+int main() {
+    vector<Cohort> cohorts;
+    cohorts.push_back(make_cohort(40, 10, "A"));
+    cohorts.push_back(make_cohort(40, 12, "B"));
+
+    vector<size_t> matching = {40, 40};
+    auto results = run_meta_analysis(cohorts, make_gene_sets(matching), 50, MetaMethod::Fisher);
+    CHECK(results.size() == 1 && results[0].num_cohorts == 2);
+
+    // A failure inside one cohort's run reaches the caller
+    vector<size_t> mismatched = {40, 41};
+    CHECK_THROWS(run_meta_analysis(cohorts, make_gene_sets(mismatched), 50,
+                                   MetaMethod::Stouffer));
+
+    // Cohorts whose sample file matches no expression column are rejected
+    cohorts[1].samples = make_cohort(40, 12, "C").samples;
+    CHECK_THROWS(run_meta_analysis(cohorts, make_gene_sets(matching), 50,
+                                   MetaMethod::Stouffer));
+
+    // A tail p-value below 1 / (sample_size + 1) reaches the combination as
+    // it is, while an empirical zero is floored
+    constexpr size_t sample_size = 99;
+    vector<PValueEstimate> tail = {{1e-6, 0, nullopt, PValueMethod::Pareto}};
+    vector<PValueEstimate> empirical_zero = {{0.0, 0}};
+    vector<size_t> one_cohort = {20};
+    auto [chi_squared, fisher_p] =
+        combine_p_values(tail, one_cohort, sample_size, MetaMethod::Fisher);
+    CHECK(abs(chi_squared + 2.0 * log(1e-6)) < 1e-9);
+    CHECK(abs(fisher_p - 1e-6) < 1e-12);
+    auto [z, stouffer_p] = combine_p_values(tail, one_cohort, sample_size, MetaMethod::Stouffer);
+    CHECK(z > 4.0 && abs(stouffer_p - 1e-6) < 1e-9);
+    auto [floored_statistic, floored_p] =
+        combine_p_values(empirical_zero, one_cohort, sample_size, MetaMethod::Fisher);
+    CHECK(abs(floored_p - 0.01) < 1e-12);
+
+    // Fisher over two cohorts: chi-squared survival on 4 degrees of freedom
+    vector<PValueEstimate> two = {{1e-6, 0, nullopt, PValueMethod::Pareto}, {0.5, 50}};
+    vector<size_t> two_cohorts = {20, 30};
+    auto [two_statistic, two_p] = combine_p_values(two, two_cohorts, sample_size,
+                                                   MetaMethod::Fisher);
+    CHECK(abs(two_p - 5e-7 * (1.0 - log(5e-7))) < 1e-12);
+
+    CHECK_THROWS(combine_p_values(tail, two_cohorts, sample_size, MetaMethod::Fisher));
+
+    return report("meta_analysis");
+}
\ No newline at end of file
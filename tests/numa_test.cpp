@@ -0,0 +1,46 @@
+#include "gsea/numa.h"
+#include "test_support.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+static vector<GeneSet> make_gene_sets(size_t num_genes) {
+    vector<GeneSet> gene_sets;
+    gene_sets.emplace_back("LOW", vector<uint32_t>{0, 1, 2, 3, 4}, num_genes);
+    gene_sets.emplace_back("SPREAD", vector<uint32_t>{5, 20, 40, 60, 80, 99}, num_genes);
+    return gene_sets;
+}
+
+int main() {
+    auto expression = make_expression(100, 12);
+    auto gene_sets = make_gene_sets(100);
+    vector<NumaNode> nodes = {{0, 2}, {1, 3}};   // fake two-node topology
+
+    // Every permutation slot is filled across both nodes' blocks
+    size_t sample_size = 57;
+    vector<double> null_distribution(sample_size * gene_sets.size(),
+                                      numeric_limits<double>::quiet_NaN());
+    compute_null_distribution_on_nodes(expression, gene_sets, 6, sample_size, nodes,
+                                       null_distribution);
+    bool all_filled = true;
+    for (double score : null_distribution) {
+        all_filled = all_filled && isfinite(score);
+    }
+    CHECK(all_filled);
+
+    // A worker failure is rethrown to the caller instead of terminating:
+    // sets resolved against a different gene count fail while scoring
+    auto mismatched_sets = make_gene_sets(101);
+    vector<double> mismatched_null(sample_size * mismatched_sets.size());
+    CHECK_THROWS(compute_null_distribution_on_nodes(expression, mismatched_sets, 6, sample_size,
+                                                    nodes, mismatched_null));
+
+    CHECK_THROWS(compute_null_distribution_on_nodes(expression, gene_sets, 12, sample_size,
+                                                    nodes, null_distribution));
+
+    return report("numa");
+}
\ No newline at end of file
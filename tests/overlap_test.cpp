@@ -0,0 +1,73 @@
+#include "gsea/overlap.h"
+#include "test_support.h"
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+// Set-at-a-time greedy filter over sorted members, as the reference
+static vector<size_t> reference_nonredundant(span<const GeneSet> gene_sets,
+                                             double threshold,
+                                             OverlapMetric metric) {
+    vector<size_t> by_size(gene_sets.size());
+    iota(by_size.begin(), by_size.end(), size_t{0});
+    ranges::stable_sort(by_size, ranges::greater{},
+                        [&](size_t s) { return gene_sets[s].size(); });
+
+    vector<size_t> kept;
+    for (size_t candidate : by_size) {
+        bool redundant = ranges::any_of(kept, [&](size_t other) {
+            vector<uint32_t> shared;
+            ranges::set_intersection(gene_sets[candidate].members(),
+                                     gene_sets[other].members(), back_inserter(shared));
+            size_t a = gene_sets[candidate].size();
+            size_t b = gene_sets[other].size();
+            double denom = metric == OverlapMetric::Jaccard
+                ? static_cast<double>(a + b - shared.size())
+                : static_cast<double>(min(a, b));
+            return denom > 0.0 && shared.size() / denom >= threshold;
+        });
+        if (!redundant) {
+            kept.push_back(candidate);
+        }
+    }
+    ranges::sort(kept);
+    return kept;
+}
+
+int main() {
+    // Sets drawn from a few overlapping pools so that many pairs are redundant
+    // and the kept list spans several tiles
+    constexpr size_t num_genes = 700;
+    mt19937 rng(7);
+    vector<GeneSet> gene_sets;
+    for (size_t s = 0; s < 300; ++s) {
+        uint32_t pool = static_cast<uint32_t>(rng() % 20) * 30;
+        size_t size = 5 + rng() % 40;
+        vector<uint32_t> members;
+        for (size_t k = 0; k < size; ++k) {
+            members.push_back(pool + static_cast<uint32_t>(rng() % 80));
+        }
+        ranges::sort(members);
+        members.erase(ranges::unique(members).begin(), members.end());
+        gene_sets.emplace_back(format("SET{}", s), std::move(members), num_genes);
+    }
+
+    for (auto metric : {OverlapMetric::Jaccard, OverlapMetric::OverlapCoefficient}) {
+        for (double threshold : {0.2, 0.5, 0.9}) {
+            auto kept = select_nonredundant_sets(gene_sets, threshold, metric);
+            CHECK(kept == reference_nonredundant(gene_sets, threshold, metric));
+        }
+    }
+
+    auto intersections = compute_intersections(gene_sets);
+    CHECK(intersections(3, 3) == gene_sets[3].size());
+    CHECK(intersections(3, 250) == intersections(250, 3));
+
+    return report("overlap");
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "gsea/permutation_store.h"
+#include "test_support.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+int main() {
+    auto directory = scratch_directory("permutation_store");
+    auto expression = make_expression(60, 10);
+
+    // Threads extending the same store to different lengths leave it holding
+    // the longest, with the rows a single writer would have produced
+    vector<thread> writers;
+    for (size_t i = 0; i < 4; ++i) {
+        writers.emplace_back([&, i] {
+            (void)PermutationStore::open((directory / "shared").string(), expression, 4, 9,
+                                         200 + 150 * i);
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    auto shared = PermutationStore::open((directory / "shared").string(), expression, 4, 9, 1);
+    auto single = PermutationStore::open((directory / "single").string(), expression, 4, 9, 650);
+    CHECK(shared.num_permutations() == 650);
+
+    vector<uint32_t> expected(60);
+    vector<uint32_t> actual(60);
+    bool rows_match = true;
+    for (size_t p = 0; p < 650; ++p) {
+        single.gene_positions(p, expected);
+        shared.gene_positions(p, actual);
+        rows_match = rows_match && ranges::equal(expected, actual);
+    }
+    CHECK(rows_match);
+
+    CHECK_THROWS(shared.gene_positions(650, actual));
+
+    return report("permutation_store");
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "gsea/radix_sort.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+// Stable descending sort by score, as the reference; -0.0 == 0.0 compares equal
+static vector<uint32_t> reference_order(span<const double> scores) {
+    vector<uint32_t> order(scores.size());
+    iota(order.begin(), order.end(), uint32_t{0});
+    ranges::stable_sort(order, [&](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+    return order;
+}
+
+static vector<uint32_t> radix_order(span<const double> scores, bool parallel) {
+    vector<uint32_t> order(scores.size());
+    radix_sort_descending(scores, order, parallel);
+    return order;
+}
+
+int main() {
+    // Above the parallel cutoff, with heavy ties from a coarse grid mixed
+    // into full-precision values of both signs
+    constexpr size_t n = 200'000;
+    mt19937_64 rng(5);
+    normal_distribution<double> normal(0.0, 3.0);
+    vector<double> scores(n);
+    for (size_t i = 0; i < n; ++i) {
+        double value = normal(rng);
+        scores[i] = i % 3 == 0 ? round(value * 4.0) / 4.0 : value;
+    }
+    scores[10] = -0.0;
+    scores[20] = 0.0;
+    scores[30] = -0.0;
+    scores[40] = numeric_limits<double>::infinity();
+    scores[50] = -numeric_limits<double>::infinity();
+    scores[60] = numeric_limits<double>::denorm_min();
+    scores[70] = -numeric_limits<double>::denorm_min();
+
+    auto expected = reference_order(scores);
+    auto sequential = radix_order(scores, false);
+    CHECK(sequential == expected);
+    CHECK(radix_order(scores, true) == sequential);
+
+    // Signed zeros tie and keep index order, between the smallest positive
+    // and the largest negative values
+    vector<double> small = {-1.5, 0.0, -0.0, 2.0, -0.0, -1e-300, 1e-300, 0.0, -2.0};
+    vector<uint32_t> small_expected = {3, 6, 1, 2, 4, 7, 5, 0, 8};
+    CHECK(radix_order(small, false) == small_expected);
+    CHECK(order_key(-0.0) == order_key(0.0));
+    CHECK(order_key(-2.0) < order_key(-1.0) && order_key(-1.0) < order_key(0.0));
+
+    // All-equal input skips every pass and stays in index order
+    vector<double> constant(1000, 0.5);
+    vector<uint32_t> identity(constant.size());
+    iota(identity.begin(), identity.end(), uint32_t{0});
+    CHECK(radix_order(constant, false) == identity);
+    CHECK(radix_order({}, false).empty());
+
+    vector<uint32_t> wrong_size(small.size() - 1);
+    CHECK_THROWS(radix_sort_descending(small, wrong_size));
+
+    return report("radix_sort");
+}
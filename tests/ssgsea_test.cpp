@@ -0,0 +1,95 @@
+#include "gsea/ssgsea.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+// Running-sum definition: rank genes by descending value, ties by index, and
+// sum over every position the weighted hit fraction minus the miss fraction
+static double running_sum_score(span<const double> values, span<const uint32_t> members,
+                                double alpha) {
+    size_t n = values.size();
+    vector<size_t> order(n);
+    iota(order.begin(), order.end(), size_t{0});
+    ranges::stable_sort(order, [&](size_t a, size_t b) { return values[a] > values[b]; });
+
+    vector<bool> in_set(n, false);
+    for (uint32_t idx : members) {
+        in_set[idx] = true;
+    }
+    double total_weight = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (in_set[order[i]]) total_weight += pow(static_cast<double>(n - i), alpha);
+    }
+    size_t num_misses = n - members.size();
+
+    double score = 0.0;
+    double hit_weight = 0.0;
+    size_t misses = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (in_set[order[i]]) {
+            hit_weight += pow(static_cast<double>(n - i), alpha);
+        } else {
+            ++misses;
+        }
+        score += hit_weight / total_weight;
+        if (num_misses > 0) {
+            score -= static_cast<double>(misses) / num_misses;
+        }
+    }
+    return score;
+}
+
+int main() {
+    // Few distinct values, so most samples rank tied genes
+    constexpr size_t num_genes = 15;
+    constexpr size_t num_samples = 6;
+    Eigen::MatrixXd values(num_genes, num_samples);
+    vector<string> gene_names;
+    vector<string> sample_names;
+    for (size_t g = 0; g < num_genes; ++g) {
+        gene_names.push_back(format("G{}", g));
+        for (size_t s = 0; s < num_samples; ++s) {
+            values(g, s) = static_cast<double>((g * 5 + s * 7) % 4) - 1.5;
+        }
+    }
+    for (size_t s = 0; s < num_samples; ++s) {
+        sample_names.push_back(format("S{}", s));
+    }
+    ExpressionData expression(values, std::move(gene_names), std::move(sample_names));
+
+    vector<vector<uint32_t>> members = {{0}, {1, 4, 9}, {2, 3, 5, 7, 11, 13}, {14, 0, 6}, {}};
+    members.back().resize(num_genes);
+    iota(members.back().begin(), members.back().end(), uint32_t{0});   // every gene
+    vector<GeneSet> gene_sets;
+    for (size_t s = 0; s < members.size(); ++s) {
+        gene_sets.emplace_back(format("SET{}", s), members[s], num_genes);
+    }
+
+    for (double alpha : {0.0, 0.25, 1.0}) {
+        auto scores = compute_ssgsea(expression, gene_sets, alpha);
+        bool matches = true;
+        for (size_t s = 0; s < num_samples; ++s) {
+            vector<double> column(num_genes);
+            for (size_t g = 0; g < num_genes; ++g) {
+                column[g] = values(g, s);
+            }
+            for (size_t k = 0; k < gene_sets.size(); ++k) {
+                double expected = running_sum_score(column, members[k], alpha);
+                matches = matches && abs(scores(s, k) - expected) <= 1e-9 * max(1.0, abs(expected));
+            }
+        }
+        CHECK(matches);
+    }
+
+    vector<GeneSet> mismatched;
+    mismatched.emplace_back("WIDE", vector<uint32_t>{0}, num_genes + 1);
+    CHECK_THROWS(compute_ssgsea(expression, mismatched));
+
+    return report("ssgsea");
+}
@@ -0,0 +1,84 @@
+#include "gsea/tail_approximation.h"
+#include "gsea/statistics.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace gsea;
+using namespace gsea::test;
+
+// n draws from GPD(shape, scale) by inversion
+static vector<double> pareto_sample(size_t n, double shape, double scale, uint64_t seed) {
+    mt19937_64 gen(seed);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    vector<double> sample(n);
+    for (auto& value : sample) {
+        value = scale * (pow(1.0 - uniform(gen), -shape) - 1.0) / shape;
+    }
+    return sample;
+}
+
+int main() {
+    // Exceedances of GPD(shape, scale) over u are GPD(shape, scale + shape * u)
+    constexpr double shape = 0.25;
+    constexpr double scale = 1.0;
+    auto heavy = pareto_sample(2000, shape, scale, 1);
+    auto fit = fit_pareto_tail(heavy);
+    CHECK(fit.has_value());
+    if (fit) {
+        CHECK(fit->exceedances == 250 && fit->null_size == 2000);
+        CHECK(abs(fit->shape - shape) < 0.2);
+        double tail_scale = scale + shape * fit->threshold;
+        CHECK(abs(fit->scale - tail_scale) < 0.3 * tail_scale);
+        CHECK(fit->ad_p_value >= 0.05);
+    }
+
+    // The top 250 mix a tight cluster with an exponential tail, which the
+    // Anderson-Darling test rejects; the search lowers the threshold count
+    // until only the exponential part is left
+    mt19937_64 gen(2);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    exponential_distribution<double> exponential(1.0);
+    vector<double> mixed;
+    for (size_t i = 0; i < 750; ++i) mixed.push_back(uniform(gen));
+    for (size_t i = 0; i < 150; ++i) mixed.push_back(5.0 + 0.01 * uniform(gen));
+    for (size_t i = 0; i < 100; ++i) mixed.push_back(10.0 + exponential(gen));
+    auto lowered = fit_pareto_tail(mixed);
+    CHECK(lowered.has_value());
+    CHECK(lowered && lowered->exceedances < 100);
+
+    // Bounded tail: GPD(-0.3, 1) ends at 1 / 0.3. A score past the fitted
+    // endpoint has no tail mass but is still given a positive p-value
+    auto bounded = pareto_sample(1000, -0.3, 1.0, 3);
+    auto bounded_fit = fit_pareto_tail(bounded);
+    CHECK(bounded_fit && bounded_fit->shape < 0.0);
+    if (bounded_fit) {
+        CHECK(pareto_tail_p_value(*bounded_fit, 10.0) == 0.0);
+    }
+    vector<double> past_endpoint = {10.0};
+    auto estimate = estimate_p_values(past_endpoint, bounded, 1, true).front();
+    CHECK(estimate.method == PValueMethod::Bound);
+    CHECK(estimate.p_value == 1.0 / 1001.0);
+
+    // A score well beyond every null value in a heavy tail is scored from
+    // the fit, below the empirical resolution
+    vector<double> extreme = {2.0 * *ranges::max_element(heavy)};
+    auto tail_estimate = estimate_p_values(extreme, heavy, 1, true).front();
+    CHECK(tail_estimate.method == PValueMethod::Pareto);
+    CHECK(tail_estimate.p_value > 0.0 && tail_estimate.p_value < 1.0 / 2000.0);
+
+    // Ten or more exceedances keep the empirical p-value
+    vector<double> sorted = heavy;
+    ranges::sort(sorted, ranges::greater{});
+    vector<double> moderate = {sorted[11]};
+    auto empirical = estimate_p_values(moderate, heavy, 1, true).front();
+    CHECK(empirical.method == PValueMethod::Empirical);
+    CHECK(empirical.count_greater == 12);
+    CHECK(empirical.p_value == 12.0 / 2000.0);
+    CHECK(!empirical.tail.has_value());
+
+    return report("tail_approximation");
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "types/expression_data.h"
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace gsea::test {
+
+inline int failures = 0;
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            std::cerr << std::format("{}:{}: CHECK({}) failed\n",                \
+                                     __FILE__, __LINE__, #condition);            \
+            ++gsea::test::failures;                                              \
+        }                                                                        \
+    } while (false)
+
+#define CHECK_THROWS(expression)                                                 \
+    do {                                                                         \
+        bool thrown = false;                                                     \
+        try {                                                                    \
+            (void)(expression);                                                  \
+        } catch (const std::exception&) {                                        \
+            thrown = true;                                                       \
+        }                                                                        \
+        if (!thrown) {                                                           \
+            std::cerr << std::format("{}:{}: {} did not throw\n",                \
+                                     __FILE__, __LINE__, #expression);           \
+            ++gsea::test::failures;                                              \
+        }                                                                        \
+    } while (false)
+
+// Deterministic, unsorted expression value of gene g in sample s
+inline double expression_value(size_t gene, size_t sample) {
+    return static_cast<double>((gene * 37 + sample * 11) % 101) / 10.0;
+}
+
+// Genes "G0".. x samples "S0".. filled with expression_value
+inline ExpressionData make_expression(size_t num_genes, size_t num_samples) {
+    Eigen::MatrixXd values(num_genes, num_samples);
+    vector<string> gene_names;
+    vector<string> sample_names;
+    for (size_t g = 0; g < num_genes; ++g) {
+        gene_names.push_back(format("G{}", g));
+        for (size_t s = 0; s < num_samples; ++s) {
+            values(g, s) = expression_value(g, s);
+        }
+    }
+    for (size_t s = 0; s < num_samples; ++s) {
+        sample_names.push_back(format("S{}", s));
+    }
+    return {std::move(values), std::move(gene_names), std::move(sample_names)};
+}
+
+// Fresh scratch directory per test executable
+inline filesystem::path scratch_directory(const string& name) {
+    auto path = filesystem::temp_directory_path() / format("gsea_test_{}", name);
+    filesystem::remove_all(path);
+    filesystem::create_directories(path);
+    return path;
+}
+
+inline void write_text(const filesystem::path& path, const string& text) {
+    ofstream out(path, ios::binary);
+    out << text;
+}
+
+inline int report(const char* name) {
+    if (failures == 0) {
+        cout << format("{}: all checks passed\n", name);
+        return 0;
+    }
+    cerr << format("{}: {} check(s) failed\n", name, failures);
+    return 1;
+}
+
+} // namespace gsea::test
\ No newline at end of file